@@ -20,7 +20,7 @@ Allocator::Allocator(Instance const& instance, Device const& device) {
 
 void Allocator::initializeAllocator(Instance const& instance, Device const& device) {
     VmaAllocatorCreateInfo allocatorCreateInfo = {};
-    //allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_;
+    allocatorCreateInfo.vulkanApiVersion = device.getApiVersion();
     allocatorCreateInfo.physicalDevice = device.getPhysical();
     allocatorCreateInfo.device = device.get();
     allocatorCreateInfo.instance = instance.get();
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/CommandPool.hpp>
+#include <VulkanObjects/CommandBuffers.hpp>
+#include <VulkanObjects/GpuTimeline.hpp>
+
+#include <vector>
+#include <deque>
+#include <stdexcept>
+
+//Compute work of the frames (culling, meshing...) submitted on its own queue, one command buffer per frame in flight.
+//With a dedicated compute family and timeline semaphores the submissions run in parallel of the graphics queue, so the compute of a frame
+//overlaps the rasterization of the previous one. The queues only wait each other for the buffers changing of queue family:
+//- compute to graphics (releaseToGraphics): acquired by the next graphics command buffer (recordGraphicsBarriers), whose submission waits the compute one
+//- graphics to compute (releaseToCompute): released by the next graphics command buffer, acquired by the first compute submission begun after it, which waits it
+//Otherwise the work is submitted on the graphics queue, before the frame, and the same calls only record barriers.
+class AsyncCompute {
+
+    public:
+
+        //Submissions of the frames are done on graphicsTimeline, which must outlive this object
+        AsyncCompute(Device const& device, GpuTimeline& graphicsTimeline, uint16_t framesInFlight)
+            : graphicsTimeline_(&graphicsTimeline), async_(device.hasDedicatedComputeQueue() && device.supportsTimelineSemaphores()),
+              graphicsFamily_(device.getQueueFamilyIndices().graphicsFamily.value()), computeFamily_(async_ ? device.getComputeFamily() : graphicsFamily_),
+              commandPool_(device, computeFamily_, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT), commandBuffers_(framesInFlight, device, commandPool_),
+              timeline_(device, async_ ? device.getComputeQueue() : device.getGraphicsQueue()), frameValues_(framesInFlight, 0) {}
+
+        ~AsyncCompute() {
+            timeline_.waitIdle();
+        }
+
+        AsyncCompute(AsyncCompute&&) = delete; //TODO: Declarer un move constructor
+        AsyncCompute& operator=(AsyncCompute&&) = delete;
+
+        AsyncCompute(const AsyncCompute&) = delete;
+        AsyncCompute& operator=(const AsyncCompute&) = delete;
+
+        //Start the command buffer of the frame (its previous submission is waited if needed),
+        //with the acquisition of the buffers released by the graphics submissions already done
+        VkCommandBuffer begin(uint32_t frameIndex) {
+
+            if (recording_) {
+                throw std::runtime_error("The compute command buffer is already recording !");
+            }
+
+            waitFrame(frameIndex);
+
+            VkCommandBuffer commandBuffer = commandBuffers_.get()[frameIndex];
+            vkResetCommandBuffer(commandBuffer, 0);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin recording compute command buffer !");
+            }
+
+            //Only the releases of submitted graphics command buffers can be acquired
+            while (!computeAcquires_.empty() && computeAcquires_.front().value <= graphicsTimeline_->getLastSubmittedValue()) {
+                PendingAcquire& pendingAcquire = computeAcquires_.front();
+
+                recordAcquire(commandBuffer, pendingAcquire.transfer);
+                waits_.push_back(graphicsTimeline_->waitFor(pendingAcquire.value, pendingAcquire.transfer.dstStages));
+
+                computeAcquires_.pop_front();
+            }
+
+            currentFrame_ = frameIndex;
+            recording_ = true;
+
+            return commandBuffer;
+
+        }
+
+        //Wait the previous compute submission of this frame, before reusing its per frame resources
+        void waitFrame(uint32_t frameIndex) {
+            timeline_.wait(frameValues_[frameIndex]);
+        }
+
+        //Submit the compute work of the frame, return its value on the compute timeline
+        uint64_t submit() {
+
+            if (!recording_) {
+                throw std::runtime_error("The compute command buffer is not recording !");
+            }
+
+            VkCommandBuffer commandBuffer = commandBuffers_.get()[currentFrame_];
+
+            if (!graphicsReleases_.barriers.empty()) {
+                if (async_) recordRelease(commandBuffer, graphicsReleases_);
+                else recordBarrier(commandBuffer, graphicsReleases_);
+            }
+
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record compute command buffer !");
+            }
+
+            uint64_t value = timeline_.submit({commandBuffer}, waits_);
+            frameValues_[currentFrame_] = value;
+
+            if (async_ && !graphicsReleases_.barriers.empty()) {
+                graphicsAcquires_.push_back({value, std::move(graphicsReleases_)});
+            }
+
+            graphicsReleases_ = {};
+            waits_.clear();
+            recording_ = false;
+
+            return value;
+
+        }
+
+        //Give a buffer range written by the compute command buffer being recorded to the graphics queue, used at dstStage by the next frame
+        void releaseToGraphics(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+
+            if (!recording_) {
+                throw std::runtime_error("The compute command buffer is not recording !");
+            }
+
+            addBarrier(graphicsReleases_, createBarrier(buffer, offset, size, srcAccess, dstAccess, computeFamily_, graphicsFamily_), srcStage, dstStage);
+
+        }
+
+        //Give a buffer range owned by the graphics queue (uploads...) to the compute queue, see isComputeReady.
+        //The release is recorded by the next graphics command buffer, after srcStage
+        void releaseToCompute(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+            addBarrier(computeReleases_, createBarrier(buffer, offset, size, srcAccess, dstAccess, graphicsFamily_, computeFamily_), srcStage, dstStage);
+        }
+
+        //Record in the next graphics command buffer (outside a render pass) the acquisition of the buffers released by the compute submissions
+        //and the release of the ones given to compute. Its submission must wait the semaphores added to waits
+        void recordGraphicsBarriers(VkCommandBuffer commandBuffer, std::vector<GpuTimeline::Wait>& waits) {
+
+            for (PendingAcquire& pendingAcquire : graphicsAcquires_) {
+                recordAcquire(commandBuffer, pendingAcquire.transfer);
+                waits.push_back(timeline_.waitFor(pendingAcquire.value, pendingAcquire.transfer.dstStages));
+            }
+            graphicsAcquires_.clear();
+
+            if (computeReleases_.barriers.empty()) return;
+
+            //This command buffer is the next submission of the graphics timeline
+            uint64_t graphicsValue = graphicsTimeline_->getLastSubmittedValue() + 1;
+
+            if (async_) {
+                recordRelease(commandBuffer, computeReleases_);
+                computeAcquires_.push_back({graphicsValue, std::move(computeReleases_)});
+            }
+            else {
+                recordBarrier(commandBuffer, computeReleases_);
+            }
+
+            computeReadyValue_ = graphicsValue;
+            computeReleases_ = {};
+
+        }
+
+        //The buffers given with releaseToCompute can be used by the next compute command buffer (their graphics release is submitted)
+        bool isComputeReady() const {
+            return computeReleases_.barriers.empty() && computeReadyValue_ <= graphicsTimeline_->getLastSubmittedValue();
+        }
+
+        //False if the compute work is submitted on the graphics queue
+        bool isAsync() const {
+            return async_;
+        }
+
+        GpuTimeline& getTimeline() {
+            return timeline_;
+        }
+
+        void waitIdle() {
+            timeline_.waitIdle();
+        }
+
+    private:
+
+        //Buffers changing of queue family together
+        struct OwnershipTransfer {
+            VkPipelineStageFlags srcStages = 0;
+            VkPipelineStageFlags dstStages = 0;
+            std::vector<VkBufferMemoryBarrier> barriers;
+        };
+
+        //Released by the submission of value (on the timeline of the releasing queue), not yet acquired by the other queue
+        struct PendingAcquire {
+            uint64_t value;
+            OwnershipTransfer transfer;
+        };
+
+        //Without async compute both sides are on the graphics queue, a simple barrier is enough
+        VkBufferMemoryBarrier createBarrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags srcAccess, VkAccessFlags dstAccess, uint32_t srcFamily, uint32_t dstFamily) const {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.srcQueueFamilyIndex = async_ ? srcFamily : VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = async_ ? dstFamily : VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = buffer;
+            barrier.offset = offset;
+            barrier.size = size;
+
+            return barrier;
+        }
+
+        static void addBarrier(OwnershipTransfer& transfer, VkBufferMemoryBarrier const& barrier, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+            transfer.srcStages |= srcStage;
+            transfer.dstStages |= dstStage;
+            transfer.barriers.push_back(barrier);
+        }
+
+        //The destination part of the barriers is ignored by the release
+        static void recordRelease(VkCommandBuffer commandBuffer, OwnershipTransfer transfer) {
+            for (VkBufferMemoryBarrier& barrier : transfer.barriers) barrier.dstAccessMask = 0;
+
+            vkCmdPipelineBarrier(commandBuffer, transfer.srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, static_cast<uint32_t>(transfer.barriers.size()), transfer.barriers.data(), 0, nullptr);
+        }
+
+        //And the source part by the acquisition, chained to the semaphore wait done at the same stages
+        static void recordAcquire(VkCommandBuffer commandBuffer, OwnershipTransfer transfer) {
+            for (VkBufferMemoryBarrier& barrier : transfer.barriers) barrier.srcAccessMask = 0;
+
+            vkCmdPipelineBarrier(commandBuffer, transfer.dstStages, transfer.dstStages, 0, 0, nullptr, static_cast<uint32_t>(transfer.barriers.size()), transfer.barriers.data(), 0, nullptr);
+        }
+
+        static void recordBarrier(VkCommandBuffer commandBuffer, OwnershipTransfer const& transfer) {
+            vkCmdPipelineBarrier(commandBuffer, transfer.srcStages, transfer.dstStages, 0, 0, nullptr, static_cast<uint32_t>(transfer.barriers.size()), transfer.barriers.data(), 0, nullptr);
+        }
+
+        GpuTimeline* graphicsTimeline_;
+        bool async_;
+
+        uint32_t graphicsFamily_;
+        uint32_t computeFamily_;
+
+        CommandPool commandPool_;
+        CommandBuffers commandBuffers_;
+
+        //Compute queue (or graphics queue without async compute)
+        GpuTimeline timeline_;
+        std::vector<uint64_t> frameValues_;
+
+        uint32_t currentFrame_ = 0;
+        bool recording_ = false;
+
+        //Graphics submissions waited by the compute command buffer being recorded
+        std::vector<GpuTimeline::Wait> waits_;
+
+        //Compute to graphics: released at the submission, then acquired by the next graphics command buffer
+        OwnershipTransfer graphicsReleases_;
+        std::deque<PendingAcquire> graphicsAcquires_;
+
+        //Graphics to compute: released by the next graphics command buffer, then acquired once it is submitted
+        OwnershipTransfer computeReleases_;
+        std::deque<PendingAcquire> computeAcquires_;
+        uint64_t computeReadyValue_ = 0;
+
+};
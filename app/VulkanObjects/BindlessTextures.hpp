@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Texture.hpp>
+#include <VulkanObjects/LayoutCache.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+//All the textures in one array of combined image samplers (descriptor indexing), bound once per frame.
+//A texture is registered at runtime and gets a handle, its index in the array, given to the shaders (push constant, uniform...).
+//GLSL: layout(set = 0, binding = 0) uniform sampler2D textures[]; then texture(textures[nonuniformEXT(handle)], uv)
+class BindlessTextures {
+
+    public:
+
+        static constexpr uint32_t BINDING = 0;
+        static constexpr uint32_t DEFAULT_CAPACITY = 4096;
+
+        BindlessTextures(Device const& device, LayoutCache& layoutCache, uint32_t capacity = DEFAULT_CAPACITY) : devicePtr_(device.get()) {
+
+            if (!device.supportsDescriptorIndexing()) {
+                throw std::runtime_error("Bindless textures require descriptor indexing !");
+            }
+
+            capacity_ = std::min(capacity, getMaxCapacity(device.getPhysical()));
+
+            createSetLayout(layoutCache);
+            createDescriptorSet();
+        }
+
+        ~BindlessTextures() {
+            //The set is freed with its pool
+            if (descriptorPool_) vkDestroyDescriptorPool(devicePtr_, descriptorPool_, nullptr);
+        }
+
+        BindlessTextures(BindlessTextures&&) = delete; //TODO: Declarer un move constructor
+        BindlessTextures& operator=(BindlessTextures&&) = delete;
+
+        BindlessTextures(const BindlessTextures&) = delete;
+        BindlessTextures& operator=(const BindlessTextures&) = delete;
+
+        //The texture must stay alive until it is released. Can be called while the set is used by frames in flight
+        uint32_t registerTexture(Texture const& texture) {
+
+            uint32_t handle;
+            if (!freeHandles_.empty()) {
+                handle = freeHandles_.back();
+                freeHandles_.pop_back();
+            }
+            else {
+                if (nextHandle_ >= capacity_) {
+                    throw std::runtime_error("Too many bindless textures !");
+                }
+                handle = nextHandle_++;
+            }
+
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = texture.getImageView();
+            imageInfo.sampler = texture.getSampler();
+
+            VkWriteDescriptorSet writeDescriptor{};
+            writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptor.dstSet = descriptorSet_;
+            writeDescriptor.dstBinding = BINDING;
+            writeDescriptor.dstArrayElement = handle;
+            writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptor.descriptorCount = 1;
+            writeDescriptor.pImageInfo = &imageInfo;
+
+            //Update after bind: valid for the frames in flight as long as they don't use this element
+            vkUpdateDescriptorSets(devicePtr_, 1, &writeDescriptor, 0, nullptr);
+
+            return handle;
+
+        }
+
+        //The frames using the handle must be finished (see VulkanWrapper::releaseBindlessTexture)
+        void releaseTexture(uint32_t handle) {
+            freeHandles_.push_back(handle);
+        }
+
+        //Stays bound while the pipelines of bindPoint have the bindless layout at the same set index
+        void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS, uint32_t setIndex = 0) const {
+            vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1, &descriptorSet_, 0, nullptr);
+        }
+
+        VkDescriptorSetLayout getSetLayout() const {
+            return setLayout_;
+        }
+
+        uint32_t getCapacity() const {
+            return capacity_;
+        }
+
+        uint32_t getTextureCount() const {
+            return nextHandle_ - static_cast<uint32_t>(freeHandles_.size());
+        }
+
+    private:
+
+        static uint32_t getMaxCapacity(VkPhysicalDevice physicalDevice) {
+
+            VkPhysicalDeviceVulkan12Properties properties12{};
+            properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+            VkPhysicalDeviceProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties.pNext = &properties12;
+
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+            //A combined image sampler counts as an image and a sampler
+            return std::min({
+                properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+                properties12.maxDescriptorSetUpdateAfterBindSamplers,
+                properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                properties12.maxPerStageDescriptorUpdateAfterBindSamplers
+            });
+
+        }
+
+        void createSetLayout(LayoutCache& layoutCache) {
+
+            VkDescriptorSetLayoutBinding binding{};
+            binding.binding = BINDING;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            binding.descriptorCount = capacity_;
+            //Visible to the graphics and the compute shaders
+            binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+            binding.pImmutableSamplers = nullptr;
+
+            //Not all the elements are written, and they are written while the set is bound
+            VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+            setLayout_ = layoutCache.getSetLayout({binding}, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, {bindingFlags});
+
+        }
+
+        //The update after bind sets need their own pool
+        void createDescriptorSet() {
+
+            VkDescriptorPoolSize poolSize{};
+            poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            poolSize.descriptorCount = capacity_;
+
+            VkDescriptorPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            poolInfo.maxSets = 1;
+            poolInfo.poolSizeCount = 1;
+            poolInfo.pPoolSizes = &poolSize;
+
+            if (vkCreateDescriptorPool(devicePtr_, &poolInfo, nullptr, &descriptorPool_) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create descriptor pool !");
+            }
+
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = descriptorPool_;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &setLayout_;
+
+            if (vkAllocateDescriptorSets(devicePtr_, &allocInfo, &descriptorSet_) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate descriptor sets !");
+            }
+
+        }
+
+        VkDevice devicePtr_;
+
+        uint32_t capacity_;
+
+        //Owned by the layout cache
+        VkDescriptorSetLayout setLayout_ = VK_NULL_HANDLE;
+
+        VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet_ = VK_NULL_HANDLE;
+
+        //Handle allocator: the released handles are reused first
+        uint32_t nextHandle_ = 0;
+        std::vector<uint32_t> freeHandles_;
+
+};
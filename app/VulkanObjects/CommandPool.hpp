@@ -3,7 +3,6 @@
 
 #include <vulkan/vulkan.h>
 
-#include <VulkanObjects/Surface.hpp>
 #include <VulkanObjects/Device.hpp>
 
 #include <stdexcept>
@@ -11,8 +10,12 @@
 class CommandPool {
 
     public:
-        CommandPool(Surface const& surface, Device const& device) : devicePtr_(device.get()) {
-            initializeCommandPool(surface, device);
+        CommandPool(Device const& device, VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+            : CommandPool(device, device.getQueueFamilyIndices().graphicsFamily.value(), flags) {};
+
+        //Command buffers of this pool can only be submitted to queues of queueFamilyIndex
+        CommandPool(Device const& device, uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags) : devicePtr_(device.get()) {
+            initializeCommandPool(queueFamilyIndex, flags);
         };
 
         ~CommandPool() {
@@ -25,15 +28,14 @@ class CommandPool {
         CommandPool(const CommandPool&) = delete;
         CommandPool& operator=(const CommandPool&) = delete;
 
-        void initializeCommandPool(Surface const& surface, Device const& device) {
-            QueueFamily::QueueFamilyIndices queueFamilyIndices = QueueFamily::findQueueFamilies(device.getPhysical(), surface.get());
+        void initializeCommandPool(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags) {
 
             VkCommandPoolCreateInfo poolInfo{};
             poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-            poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Allow te rewrite command buffer every frame
-            poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value(); //TODO: rendre paramétrable la graphic family
+            poolInfo.flags = flags; // RESET_COMMAND_BUFFER allow te rewrite command buffer every frame
+            poolInfo.queueFamilyIndex = queueFamilyIndex;
 
-            if (vkCreateCommandPool(device.get(), &poolInfo, nullptr, &commandPool_) != VK_SUCCESS) {
+            if (vkCreateCommandPool(devicePtr_, &poolInfo, nullptr, &commandPool_) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to create command pool !");
             }
 
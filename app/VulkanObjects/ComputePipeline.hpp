@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Shader.hpp>
+#include <VulkanObjects/ShaderModuleCache.hpp>
+#include <VulkanObjects/SpecializationConstants.hpp>
+
+#include <stdexcept>
+
+//Compute pipeline of a compute shader (see the compute constructor of Shader).
+//The dispatches can be recorded in the command buffer of the frame, before the render pass (see VulkanWrapper::beginRecordingDraw),
+//or in any other command buffer of a queue supporting compute.
+class ComputePipeline {
+
+    public:
+
+        //specialization overrides the default constants of the shader
+        ComputePipeline(Device const& device, ShaderModuleCache& shaderModuleCache, Shader const& shader, SpecializationConstants const& specialization = {}) : devicePtr_(device.get()), shaderPtr_(&shader) {
+
+            if (!shader.isCompute()) {
+                throw std::runtime_error("A compute pipeline needs a compute shader !");
+            }
+
+            SpecializationConstants constants = shader.getComputeSpecialization();
+            constants.merge(specialization);
+
+            SpecializationConstants::Info specializationInfo;
+            constants.fill(specializationInfo);
+
+            VkPipelineShaderStageCreateInfo stageInfo{};
+            stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            stageInfo.module = shaderModuleCache.get(shader.getComputeFilename());
+            stageInfo.pName = "main";
+            stageInfo.pSpecializationInfo = constants.empty() ? nullptr : &specializationInfo.info;
+
+            VkComputePipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipelineInfo.stage = stageInfo;
+            pipelineInfo.layout = shader.getPipelineLayout();
+
+            if (vkCreateComputePipelines(devicePtr_, device.getPipelineCache(), 1, &pipelineInfo, nullptr, &computePipeline_) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create the compute pipeline !");
+            }
+
+        }
+
+        //The GPU must be done with the pipeline
+        ~ComputePipeline() {
+            if (computePipeline_) vkDestroyPipeline(devicePtr_, computePipeline_, nullptr);
+        }
+
+        ComputePipeline(ComputePipeline&&) = delete; //TODO: Declarer un move constructor
+        ComputePipeline& operator=(ComputePipeline&&) = delete;
+
+        ComputePipeline(const ComputePipeline&) = delete;
+        ComputePipeline& operator=(const ComputePipeline&) = delete;
+
+        //The sets of the shader are bound with Shader::bind (they use the compute bind point)
+        inline void bind(VkCommandBuffer commandBuffer) const {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline_);
+        }
+
+        inline void dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) const {
+            vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+        }
+
+        //The group counts are read from a VkDispatchIndirectCommand written in the buffer
+        inline void dispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset = 0) const {
+            vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+        }
+
+        //Number of groups to cover invocationCount invocations
+        static uint32_t getGroupCount(uint32_t invocationCount, uint32_t groupSize) {
+            return (invocationCount + groupSize - 1) / groupSize;
+        }
+
+        //Make the writes of a stage visible to the reads of another (compute to indirect draw, compute to vertex input...)
+        static void recordBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        inline VkPipeline get() const {
+            return computePipeline_;
+        }
+
+        inline Shader const& getShader() const {
+            return *shaderPtr_;
+        }
+
+    private:
+
+        VkDevice devicePtr_;
+        Shader const* shaderPtr_;
+
+        VkPipeline computePipeline_ = VK_NULL_HANDLE;
+
+};
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <string>
 
 
 const std::vector<const char*> validationLayers = {
@@ -12,3 +13,14 @@ const std::vector<const char*> validationLayers = {
 const std::vector<const char*> deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
+
+//Headless devices never present, so they don't need the swapchain extension
+const std::vector<const char*> headlessDeviceExtensions = {};
+
+//Enabled when available
+const std::vector<const char*> optionalPushDescriptorExtensions = {
+    VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME
+};
+
+//Where the pipeline cache is kept between launches
+const std::string pipelineCacheFilename = "pipeline_cache.bin";
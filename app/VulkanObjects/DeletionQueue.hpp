@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <functional>
+
+//Destroy the Vulkan objects once the GPU is done with them, instead of waiting the device idle.
+//Each deletion is keyed by a timeline value: it runs once this value is completed.
+class DeletionQueue {
+
+    public:
+        DeletionQueue() {};
+
+        //Note: the GPU must be idle
+        ~DeletionQueue() {
+            flush();
+        }
+
+        DeletionQueue(DeletionQueue&&) = delete; //TODO: Declarer un move constructor
+        DeletionQueue& operator=(DeletionQueue&&) = delete;
+
+        DeletionQueue(const DeletionQueue&) = delete;
+        DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+        //The values must be pushed in increasing order
+        void push(uint64_t value, std::function<void()> deletion) {
+            deletions_.emplace_back(value, std::move(deletion));
+        }
+
+        //Run the deletions whose value is completed
+        void collect(uint64_t completedValue) {
+            while (!deletions_.empty() && deletions_.front().first <= completedValue) {
+                deletions_.front().second();
+                deletions_.pop_front();
+            }
+        }
+
+        //Run all the deletions, the GPU must be idle
+        void flush() {
+            collect(UINT64_MAX);
+        }
+
+        bool empty() const {
+            return deletions_.empty();
+        }
+
+    private:
+        std::deque<std::pair<uint64_t, std::function<void()>>> deletions_;
+
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+
+//Descriptor sets of all the shaders, allocated from shared pools.
+//A new pool is created when the current one is exhausted, each one bigger than the previous.
+//Persistent sets live until freed, transient sets live until their frame in flight is reset.
+class DescriptorAllocator {
+
+    public:
+
+        //Descriptors of each type per set, to size the pools
+        struct PoolSizeRatio {
+            VkDescriptorType type;
+            float ratio;
+        };
+
+        DescriptorAllocator(Device const& device, uint16_t framesInFlight, uint32_t setsPerPool = 64) : devicePtr_(device.get()), transientPools_(framesInFlight) {
+            persistentPools_.setsPerPool = setsPerPool;
+            for (PoolList& pools : transientPools_) pools.setsPerPool = setsPerPool;
+        }
+
+        ~DescriptorAllocator() {
+            destroyPools(persistentPools_);
+            for (PoolList& pools : transientPools_) destroyPools(pools);
+        }
+
+        DescriptorAllocator(DescriptorAllocator&&) = delete; //TODO: Declarer un move constructor
+        DescriptorAllocator& operator=(DescriptorAllocator&&) = delete;
+
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+        //Valid until freed
+        VkDescriptorSet allocate(VkDescriptorSetLayout layout) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            VkDescriptorPool pool;
+            VkDescriptorSet set = allocate(persistentPools_, layout, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, pool);
+
+            poolOfSet_[set] = pool;
+            return set;
+        }
+
+        //The GPU must be done with the sets
+        void free(std::vector<VkDescriptorSet> const& sets) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (VkDescriptorSet set : sets) {
+                auto found = poolOfSet_.find(set);
+                if (found == poolOfSet_.end()) {
+                    throw std::runtime_error("Freeing a descriptor set not allocated by this allocator !");
+                }
+
+                VkDescriptorPool pool = found->second;
+                vkFreeDescriptorSets(devicePtr_, pool, 1, &set);
+                poolOfSet_.erase(found);
+
+                //It has free space again
+                auto full = std::find(persistentPools_.full.begin(), persistentPools_.full.end(), pool);
+                if (full != persistentPools_.full.end()) {
+                    persistentPools_.full.erase(full);
+                    persistentPools_.available.push_back(pool);
+                }
+            }
+        }
+
+        //Valid until resetFrame is called for this frame, nothing to free
+        VkDescriptorSet allocateTransient(uint32_t frameIndex, VkDescriptorSetLayout layout) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            VkDescriptorPool pool;
+            return allocate(transientPools_[frameIndex], layout, 0, pool);
+        }
+
+        //Free all the transient sets of the frame at once, the GPU must be done with them
+        void resetFrame(uint32_t frameIndex) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            PoolList& pools = transientPools_[frameIndex];
+
+            pools.available.insert(pools.available.end(), pools.full.begin(), pools.full.end());
+            pools.full.clear();
+
+            for (VkDescriptorPool pool : pools.available) {
+                vkResetDescriptorPool(devicePtr_, pool, 0);
+            }
+        }
+
+        size_t getPoolCount() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            size_t count = persistentPools_.full.size() + persistentPools_.available.size();
+            for (PoolList const& pools : transientPools_) count += pools.full.size() + pools.available.size();
+            return count;
+        }
+
+    private:
+
+        struct PoolList {
+            //The last available pool is the one allocating
+            std::vector<VkDescriptorPool> available;
+            std::vector<VkDescriptorPool> full;
+
+            //Size of the next pool created
+            uint32_t setsPerPool;
+        };
+
+        //The mutex must be locked
+        VkDescriptorSet allocate(PoolList& pools, VkDescriptorSetLayout layout, VkDescriptorPoolCreateFlags flags, VkDescriptorPool& pool) {
+
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &layout;
+
+            VkDescriptorSet set;
+
+            while (true) {
+
+                bool newPool = pools.available.empty();
+                if (newPool) pools.available.push_back(createPool(pools, flags));
+
+                allocInfo.descriptorPool = pools.available.back();
+                VkResult result = vkAllocateDescriptorSets(devicePtr_, &allocInfo, &set);
+
+                if (result == VK_SUCCESS) break;
+
+                //Exhausted, try the next pool (a new pool failing means the set can't fit in any pool)
+                if ((result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) && !newPool) {
+                    pools.full.push_back(pools.available.back());
+                    pools.available.pop_back();
+                    continue;
+                }
+
+                throw std::runtime_error("Failed to allocate descriptor sets !");
+            }
+
+            pool = allocInfo.descriptorPool;
+            return set;
+
+        }
+
+        VkDescriptorPool createPool(PoolList& pools, VkDescriptorPoolCreateFlags flags) {
+
+            std::vector<VkDescriptorPoolSize> poolSizes;
+            for (PoolSizeRatio const& poolSizeRatio : POOL_SIZE_RATIOS) {
+                poolSizes.push_back({poolSizeRatio.type, static_cast<uint32_t>(poolSizeRatio.ratio * pools.setsPerPool)});
+            }
+
+            VkDescriptorPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.flags = flags;
+            poolInfo.maxSets = pools.setsPerPool;
+            poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+            poolInfo.pPoolSizes = poolSizes.data();
+
+            VkDescriptorPool pool;
+            if (vkCreateDescriptorPool(devicePtr_, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create descriptor pool !");
+            }
+
+            //Fewer pools when a lot of sets are needed
+            pools.setsPerPool = std::min(pools.setsPerPool * 2, MAX_SETS_PER_POOL);
+
+            return pool;
+
+        }
+
+        void destroyPools(PoolList& pools) {
+            for (VkDescriptorPool pool : pools.available) vkDestroyDescriptorPool(devicePtr_, pool, nullptr);
+            for (VkDescriptorPool pool : pools.full) vkDestroyDescriptorPool(devicePtr_, pool, nullptr);
+            pools.available.clear();
+            pools.full.clear();
+        }
+
+        static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+        static constexpr PoolSizeRatio POOL_SIZE_RATIOS[] = {
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f}
+        };
+
+        VkDevice devicePtr_;
+
+        mutable std::mutex mutex_;
+
+        PoolList persistentPools_;
+        std::vector<PoolList> transientPools_;
+
+        //To free the persistent sets
+        std::unordered_map<VkDescriptorSet, VkDescriptorPool> poolOfSet_;
+
+};
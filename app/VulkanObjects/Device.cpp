@@ -4,13 +4,24 @@
 #include <VulkanObjects/Device.hpp>
 
 
-Device::Device(Instance const& instance, Surface const& surface, bool enableValidationLayers) {
+Device::Device(Instance const& instance, Surface const& surface, bool enableValidationLayers) : apiVersion_(instance.getApiVersion()) {
     pickPhysicalDevice(instance.get(), surface.get());
     createLogicalDevice(surface.get(), enableValidationLayers);
     allocator_.initializeAllocator(instance, *this);
+    pipelineCache_.initialize(device_, physicalDevice_, pipelineCacheFilename);
+};
+
+Device::Device(Instance const& instance, bool enableValidationLayers) : headless_(true), apiVersion_(instance.getApiVersion()) {
+    pickPhysicalDevice(instance.get(), VK_NULL_HANDLE);
+    createLogicalDevice(VK_NULL_HANDLE, enableValidationLayers);
+    allocator_.initializeAllocator(instance, *this);
+    pipelineCache_.initialize(device_, physicalDevice_, pipelineCacheFilename);
 };
 
 Device::~Device() {
+    pipelineCache_.save();
+    pipelineCache_.clean();
+
     allocator_.~Allocator();
     vkDestroyDevice(device_, nullptr);
 }
@@ -22,25 +33,70 @@ void Device::pickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface) {
     if (physicalDevice_ == VK_NULL_HANDLE) {
         throw std::runtime_error("failed to find a suitable GPU !");
     }
+
+    //The version used is the lowest between the instance and the device
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice_, &properties);
+    apiVersion_ = std::min(apiVersion_, properties.apiVersion);
+
+    //Timeline semaphores and descriptor indexing are core in Vulkan 1.2, but still optional features
+    if (apiVersion_ >= VK_API_VERSION_1_2) {
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &features12;
+
+        vkGetPhysicalDeviceFeatures2(physicalDevice_, &features);
+
+        timelineSemaphoreSupported_ = features12.timelineSemaphore;
+
+        //Draw count read from a buffer (vkCmdDrawIndexedIndirectCount)
+        drawIndirectCountSupported_ = features12.drawIndirectCount;
+
+        //What the bindless textures need
+        descriptorIndexingSupported_ = features12.runtimeDescriptorArray && features12.descriptorBindingPartiallyBound
+            && features12.descriptorBindingSampledImageUpdateAfterBind && features12.descriptorBindingUpdateUnusedWhilePending
+            && features12.shaderSampledImageArrayNonUniformIndexing;
+    }
+
+    //Many draws per indirect call, the indirect draws fall back to one call per draw without it
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice_, &supportedFeatures);
+    multiDrawIndirectSupported_ = supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance;
+
+    //Optional, the per draw descriptors fall back to transient sets without it
+    pushDescriptorSupported_ = Checker::deviceExtensionSupport(physicalDevice_, optionalPushDescriptorExtensions);
     
 }
 
 void Device::createLogicalDevice(VkSurfaceKHR surface, bool enableValidationLayers) {
-    QueueFamily::QueueFamilyIndices indices = QueueFamily::findQueueFamilies(physicalDevice_, surface);
+    queueFamilyIndices_ = QueueFamily::findQueueFamilies(physicalDevice_, surface);
+    QueueFamily::QueueFamilyIndices const& indices = queueFamilyIndices_;
 
     //The requested queue families
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value()};
+    if (indices.presentFamily) uniqueQueueFamilies.insert(indices.presentFamily.value());
+    if (indices.transferFamily) uniqueQueueFamilies.insert(indices.transferFamily.value());
+    if (indices.computeFamily) uniqueQueueFamilies.insert(indices.computeFamily.value());
+
+    //If the transfers and the async compute use the same family, they get their own queue when the family has more than one
+    uint32_t computeQueueIndex = 0;
+    if (indices.computeFamily && indices.computeFamily == indices.transferFamily && QueueFamily::getQueueFamilies(physicalDevice_)[indices.computeFamily.value()].queueCount > 1) {
+        computeQueueIndex = 1;
+    }
 
-    float queuePriority = 1.0f;
+    float queuePriorities[] = {1.0f, 1.0f};
     for (uint32_t queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo{};
         queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         queueCreateInfo.queueFamilyIndex = queueFamily;
-        queueCreateInfo.queueCount = 1;
+        queueCreateInfo.queueCount = (indices.computeFamily == queueFamily) ? computeQueueIndex + 1 : 1;
 
         //Priority of the queue, from 0.0 (low) to 1.0 (Max)
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        queueCreateInfo.pQueuePriorities = queuePriorities;
 
         //Add the queue informations to the vector of queue informations
         queueCreateInfos.push_back(queueCreateInfo);
@@ -50,6 +106,8 @@ void Device::createLogicalDevice(VkSurfaceKHR surface, bool enableValidationLaye
     //Specify the special features of the device we want to use in the queue (can be empty)
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.multiDrawIndirect = multiDrawIndirectSupported_;
+    deviceFeatures.drawIndirectFirstInstance = multiDrawIndirectSupported_;
 
     //Logical device informations
     VkDeviceCreateInfo createInfo{};
@@ -60,8 +118,23 @@ void Device::createLogicalDevice(VkSurfaceKHR surface, bool enableValidationLaye
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.timelineSemaphore = timelineSemaphoreSupported_;
+    features12.drawIndirectCount = drawIndirectCountSupported_;
+
+    features12.runtimeDescriptorArray = descriptorIndexingSupported_;
+    features12.descriptorBindingPartiallyBound = descriptorIndexingSupported_;
+    features12.descriptorBindingSampledImageUpdateAfterBind = descriptorIndexingSupported_;
+    features12.descriptorBindingUpdateUnusedWhilePending = descriptorIndexingSupported_;
+    features12.shaderSampledImageArrayNonUniformIndexing = descriptorIndexingSupported_;
+
+    if (apiVersion_ >= VK_API_VERSION_1_2) createInfo.pNext = &features12;
+
+    std::vector<const char*> extensions = headless_ ? headlessDeviceExtensions : deviceExtensions;
+    if (pushDescriptorSupported_) extensions.insert(extensions.end(), optionalPushDescriptorExtensions.begin(), optionalPushDescriptorExtensions.end());
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
     
 
     //This may be useless, validations layers are now useless in device since they use now the same as the instance validation layer
@@ -78,7 +151,15 @@ void Device::createLogicalDevice(VkSurfaceKHR surface, bool enableValidationLaye
 
     //Retrieve the queues we want to use and keep a pointer to them
     vkGetDeviceQueue(device_, indices.graphicsFamily.value(), 0, &graphicsQueue_);
-    vkGetDeviceQueue(device_, indices.presentFamily.value(), 0, &presentQueue_);
+    if (indices.presentFamily) vkGetDeviceQueue(device_, indices.presentFamily.value(), 0, &presentQueue_);
+    vkGetDeviceQueue(device_, getTransferFamily(), 0, &transferQueue_);
+    vkGetDeviceQueue(device_, getComputeFamily(), computeQueueIndex, &computeQueue_);
+
+    //Extension function, not exported by the loader
+    if (pushDescriptorSupported_) {
+        cmdPushDescriptorSet_ = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(vkGetDeviceProcAddr(device_, "vkCmdPushDescriptorSetKHR"));
+        pushDescriptorSupported_ = cmdPushDescriptorSet_ != nullptr;
+    }
 
 }
         
\ No newline at end of file
@@ -6,9 +6,13 @@
 #include <VulkanObjects/Allocator.hpp>
 #include <VulkanObjects/Instance.hpp>
 #include <VulkanObjects/Surface.hpp>
+#include <VulkanObjects/PipelineCache.hpp>
 
 #include <VulkanObjects/Helper/PhysicalDevices.hpp>
+#include <VulkanObjects/Helper/Checker.hpp>
 
+#include <vector>
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -17,6 +21,9 @@ class Device {
     public:
         Device(Instance const& instance, Surface const& surface, bool enableValidationLayers = false);
 
+        //Headless device, no surface so no present queue nor swapchain extension
+        Device(Instance const& instance, bool enableValidationLayers = false);
+
         ~Device();
 
         Device(Device&&) = delete; //TODO: Declarer un move constructor
@@ -45,18 +52,113 @@ class Device {
             return presentQueue_;
         };
 
+        //Fall back to the graphics queue if there is no separate transfer family
+        inline VkQueue getTransferQueue() const {
+            return transferQueue_;
+        }
+
+        inline uint32_t getTransferFamily() const {
+            return queueFamilyIndices_.transferFamily.value_or(queueFamilyIndices_.graphicsFamily.value());
+        }
+
+        inline bool hasDedicatedTransferQueue() const {
+            return queueFamilyIndices_.transferFamily.has_value();
+        }
+
+        //Fall back to the graphics queue if there is no compute family without graphics
+        inline VkQueue getComputeQueue() const {
+            return computeQueue_;
+        }
+
+        inline uint32_t getComputeFamily() const {
+            return queueFamilyIndices_.computeFamily.value_or(queueFamilyIndices_.graphicsFamily.value());
+        }
+
+        inline bool hasDedicatedComputeQueue() const {
+            return queueFamilyIndices_.computeFamily.has_value();
+        }
+
+        //Families of the buffers read by both the graphics and the compute queues without ownership transfers (concurrent sharing), empty if they are the same
+        inline std::vector<uint32_t> getGraphicsComputeFamilies() const {
+            if (!hasDedicatedComputeQueue()) return {};
+            return {queueFamilyIndices_.graphicsFamily.value(), getComputeFamily()};
+        }
+
+        inline QueueFamily::QueueFamilyIndices const& getQueueFamilyIndices() const {
+            return queueFamilyIndices_;
+        }
+
+        //Vulkan version usable with this device
+        inline uint32_t getApiVersion() const {
+            return apiVersion_;
+        }
+
+        inline bool supportsTimelineSemaphores() const {
+            return timelineSemaphoreSupported_;
+        }
+
+        //Bindless textures: partially bound, update after bind, non uniform indexed sampler arrays
+        inline bool supportsDescriptorIndexing() const {
+            return descriptorIndexingSupported_;
+        }
+
+        //VK_KHR_push_descriptor
+        inline bool supportsPushDescriptors() const {
+            return pushDescriptorSupported_;
+        }
+
+        //drawCount > 1 in vkCmdDrawIndexedIndirect, and firstInstance in the indirect commands
+        inline bool supportsMultiDrawIndirect() const {
+            return multiDrawIndirectSupported_;
+        }
+
+        //vkCmdDrawIndexedIndirectCount (Vulkan 1.2)
+        inline bool supportsDrawIndirectCount() const {
+            return drawIndirectCountSupported_;
+        }
+
+        inline void cmdPushDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, uint32_t writeCount, const VkWriteDescriptorSet* writes) const {
+            cmdPushDescriptorSet_(commandBuffer, bindPoint, layout, set, writeCount, writes);
+        }
+
+        inline bool isHeadless() const {
+            return headless_;
+        }
+
         inline VmaAllocator getAllocator() const {
             return allocator_.get();
         }
 
+        //Shared by all the pipelines created on this device
+        inline VkPipelineCache getPipelineCache() const {
+            return pipelineCache_.get();
+        }
+
     private:
         VkDevice device_;
         VkPhysicalDevice physicalDevice_ = VK_NULL_HANDLE;;
 
+        bool headless_ = false;
+
+        uint32_t apiVersion_;
+        bool timelineSemaphoreSupported_ = false;
+        bool descriptorIndexingSupported_ = false;
+        bool pushDescriptorSupported_ = false;
+        bool multiDrawIndirectSupported_ = false;
+        bool drawIndirectCountSupported_ = false;
+
+        PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet_ = nullptr;
+
         //Queues (note: the queues are implicitly cleaned up when the device is destroyed)
+        QueueFamily::QueueFamilyIndices queueFamilyIndices_;
         VkQueue graphicsQueue_;
-        VkQueue presentQueue_;
+        VkQueue presentQueue_ = VK_NULL_HANDLE;
+        VkQueue transferQueue_;
+        VkQueue computeQueue_;
 
         //Allocator to reserve memory on GPU
         Allocator allocator_;
+
+        //Loaded at creation, saved at destruction
+        PipelineCache pipelineCache_;
 };
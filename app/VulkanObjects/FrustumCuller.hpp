@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/UploadManager.hpp>
+#include <VulkanObjects/UniformRing.hpp>
+#include <VulkanObjects/DescriptorAllocator.hpp>
+#include <VulkanObjects/LayoutCache.hpp>
+#include <VulkanObjects/ShaderModuleCache.hpp>
+#include <VulkanObjects/Shader.hpp>
+#include <VulkanObjects/ComputePipeline.hpp>
+#include <VulkanObjects/IndirectDrawBuffer.hpp>
+#include <VulkanObjects/AsyncCompute.hpp>
+#include <VulkanObjects/MeshArena.hpp>
+#include <VulkanObjects/Helper/Buffer.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <filesystem>
+#include <stdexcept>
+
+//Frustum culling on the GPU: a compute shader (Shaders/cull.comp) tests the bounding box of each object against the camera
+//and writes the draw commands of the visible ones in the region of the frame of an IndirectDrawBuffer, drawn with IndirectDrawBuffer::drawCount.
+//With drawIndirectCount the visible commands are compacted with an atomic counter, without it each object keeps its command with 0 instance when culled.
+//record must be called outside of the render pass (see the callback of VulkanWrapper::beginRecordingDraw),
+//or in the compute command buffer of the frame with async compute (the draw commands are then released to the graphics queue).
+class FrustumCuller {
+
+    public:
+
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+        //Same layout as the shader (std430)
+        struct CullingObject {
+            glm::vec3 aabbMin;
+            uint32_t indexCount;
+            glm::vec3 aabbMax;
+            uint32_t firstIndex;
+            int32_t vertexOffset;
+            uint32_t firstInstance;
+            uint32_t pad[2] = {0, 0};
+        };
+
+        //Same layout as the shader (std140)
+        struct Camera {
+            glm::mat4 view;
+            glm::mat4 proj;
+        };
+
+        static CullingObject createObject(MeshArena::Mesh const& mesh, glm::vec3 const& aabbMin, glm::vec3 const& aabbMax, uint32_t firstInstance = 0) {
+            return {aabbMin, mesh.indexCount, aabbMax, mesh.firstIndex, mesh.vertexOffset, firstInstance};
+        }
+
+        FrustumCuller(Device const& device, ShaderModuleCache& shaderModuleCache, LayoutCache& layoutCache, DescriptorAllocator& descriptorAllocator, UploadManager& uploadManager, UniformRing& uniformRing,
+            IndirectDrawBuffer const& indirectDrawBuffer, uint16_t framesInFlight, std::string const& shaderFilename = "Shaders/cull.comp.spv", AsyncCompute* asyncCompute = nullptr)
+            : device_(&device), uploadManager_(&uploadManager), uniformRing_(&uniformRing), indirectDrawBuffer_(&indirectDrawBuffer), asyncCompute_(asyncCompute),
+              maxObjects_(indirectDrawBuffer.getMaxDraws()), compact_(device.supportsDrawIndirectCount()),
+              shader_(&device, &descriptorAllocator, &layoutCache, framesInFlight, shaderFilename) {
+
+            if (!indirectDrawBuffer.isGpuWritten()) {
+                throw std::runtime_error("The culling needs an indirect draw buffer written on the GPU !");
+            }
+
+            //The compiled shader is not versioned, it is built from Shaders/cull.comp by compileShader.cmd
+            if (!std::filesystem::exists(shaderFilename)) {
+                throw std::runtime_error(std::string {"Missing culling shader "} + shaderFilename + ", compile Shaders/cull.comp with compileShader.cmd !");
+            }
+
+            Buffer::create(device_->getAllocator(), sizeof(CullingObject) * maxObjects_, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, objectsBuffer_, objectsBufferAllocation_, nullptr);
+
+            //The draw commands are written in the region of the current frame
+            std::vector<VkDescriptorBufferInfo> commandsInfos(framesInFlight);
+            for (uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex) {
+                commandsInfos[frameIndex] = indirectDrawBuffer.getFrameBufferInfo(frameIndex);
+            }
+
+            shader_.addDynamicUniformBufferObjects(uniformRing, {
+                {0, sizeof(Camera), VK_SHADER_STAGE_COMPUTE_BIT}
+            });
+
+            shader_.addStorageBuffers({
+                {1, VK_SHADER_STAGE_COMPUTE_BIT, {{objectsBuffer_, 0, VK_WHOLE_SIZE}}},
+                {2, VK_SHADER_STAGE_COMPUTE_BIT, commandsInfos}
+            });
+
+            shader_.setPushConstant({sizeof(PushConstants), VK_SHADER_STAGE_COMPUTE_BIT});
+
+            shader_.generateBindingsAndSets();
+
+            pipeline_.emplace(device, shaderModuleCache, shader_);
+        }
+
+        ~FrustumCuller() {
+
+            //The pipeline and the shader are destroyed after
+            if (objectsBuffer_) vmaDestroyBuffer(device_->getAllocator(), objectsBuffer_, objectsBufferAllocation_);
+
+        }
+
+        FrustumCuller(FrustumCuller&&) = delete; //TODO: Declarer un move constructor
+        FrustumCuller& operator=(FrustumCuller&&) = delete;
+
+        FrustumCuller(const FrustumCuller&) = delete;
+        FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+        //Copied on the GPU with the next flush of the upload manager, the frames in flight must not be culling anymore.
+        //With async compute they are given to the compute queue by the next frame, the culling can start again once isReady.
+        //firstObject allows to update only a part of the objects
+        void setObjects(std::vector<CullingObject> const& objects, uint32_t firstObject = 0) {
+
+            if (firstObject + objects.size() > maxObjects_) {
+                throw std::runtime_error("Too many objects to cull !");
+            }
+
+            VkDeviceSize size = sizeof(CullingObject) * objects.size();
+            VkDeviceSize offset = sizeof(CullingObject) * firstObject;
+
+            uploadManager_->uploadBuffer(objectsBuffer_, objects.data(), size, offset);
+
+            //The uploads are acquired by the graphics queue (or done on it)
+            if (asyncCompute_) {
+                asyncCompute_->releaseToCompute(objectsBuffer_, offset, size, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+            }
+
+        }
+
+        //Cull the first objectCount objects into the region of the frame of the indirect draw buffer
+        void record(VkCommandBuffer commandBuffer, uint32_t frameIndex, Camera const& camera, uint32_t objectCount) {
+
+            if (objectCount > maxObjects_) {
+                throw std::runtime_error("Too many objects to cull !");
+            }
+
+            if (!isReady()) {
+                throw std::runtime_error("The objects to cull are not yet given to the compute queue !");
+            }
+
+            uint32_t cameraOffset = uniformRing_->push(&camera, sizeof(Camera));
+
+            VkDescriptorBufferInfo commandsInfo = indirectDrawBuffer_->getFrameBufferInfo(frameIndex);
+
+            //Reset the counter, or all the commands when they are not compacted
+            vkCmdFillBuffer(commandBuffer, commandsInfo.buffer, commandsInfo.offset, compact_ ? sizeof(uint32_t) : commandsInfo.range, 0);
+
+            ComputePipeline::recordBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+            PushConstants pushConstants{objectCount, compact_ ? 1u : 0u};
+
+            pipeline_->bind(commandBuffer);
+            shader_.bind(commandBuffer, frameIndex, {&cameraOffset, 1});
+            shader_.recordPushConstant(commandBuffer, &pushConstants, sizeof(PushConstants));
+
+            pipeline_->dispatch(commandBuffer, ComputePipeline::getGroupCount(objectCount, WORKGROUP_SIZE));
+
+            //The draw commands and the counter are read by the indirect draws
+            if (asyncCompute_) {
+                asyncCompute_->releaseToGraphics(commandsInfo.buffer, commandsInfo.offset, commandsInfo.range, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+            }
+            else {
+                ComputePipeline::recordBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+            }
+
+        }
+
+        //With async compute, false until the objects set are given to the compute queue
+        bool isReady() const {
+            return !asyncCompute_ || asyncCompute_->isComputeReady();
+        }
+
+        uint32_t getMaxObjects() const {
+            return maxObjects_;
+        }
+
+    private:
+
+        struct PushConstants {
+            uint32_t objectCount;
+            uint32_t compact;
+        };
+
+        //Vulkan objects
+        const Device* device_;
+        UploadManager* uploadManager_;
+        UniformRing* uniformRing_;
+        IndirectDrawBuffer const* indirectDrawBuffer_;
+        AsyncCompute* asyncCompute_;
+
+        uint32_t maxObjects_;
+        bool compact_;
+
+        VkBuffer objectsBuffer_ = VK_NULL_HANDLE;
+        VmaAllocation objectsBufferAllocation_ = VK_NULL_HANDLE;
+
+        Shader shader_;
+        std::optional<ComputePipeline> pipeline_;
+
+};
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
+
+//Progress of the GPU on one queue: each submission signals the next value of a monotonically increasing counter,
+//so knowing if a resource is still in use is a single comparison with the last completed value.
+//Uses a timeline semaphore (Vulkan 1.2) if supported, otherwise one fence per pending submission.
+class GpuTimeline {
+
+    public:
+
+        //A semaphore to wait before the given stages. value is ignored for binary semaphores
+        struct Wait {
+            VkSemaphore semaphore;
+            uint64_t value;
+            VkPipelineStageFlags stages;
+        };
+
+        GpuTimeline(Device const& device, VkQueue queue) : devicePtr_(device.get()), queue_(queue), timelineMode_(device.supportsTimelineSemaphores()) {
+            if (timelineMode_) initializeTimelineSemaphore();
+        }
+
+        ~GpuTimeline() {
+            if (timelineMode_) {
+                vkDestroySemaphore(devicePtr_, semaphore_, nullptr);
+                return;
+            }
+
+            //Note: the submissions must be finished
+            for (auto [value, fence] : pendingFences_) {
+                vkDestroyFence(devicePtr_, fence, nullptr);
+            }
+            for (VkFence fence : freeFences_) {
+                vkDestroyFence(devicePtr_, fence, nullptr);
+            }
+        }
+
+        GpuTimeline(GpuTimeline&&) = delete; //TODO: Declarer un move constructor
+        GpuTimeline& operator=(GpuTimeline&&) = delete;
+
+        GpuTimeline(const GpuTimeline&) = delete;
+        GpuTimeline& operator=(const GpuTimeline&) = delete;
+
+        //Submit the command buffers on the queue, signaling the next value of the timeline (and the binary signalSemaphores).
+        //Return the value, completed once the submission is finished.
+        uint64_t submit(std::vector<VkCommandBuffer> const& commandBuffers, std::vector<Wait> const& waits = {}, std::vector<VkSemaphore> const& signalSemaphores = {}) {
+
+            uint64_t value = lastSubmittedValue_ + 1;
+
+            std::vector<VkSemaphore> waitSemaphores;
+            std::vector<uint64_t> waitValues;
+            std::vector<VkPipelineStageFlags> waitStages;
+
+            for (Wait const& wait : waits) {
+                waitSemaphores.push_back(wait.semaphore);
+                waitValues.push_back(wait.value);
+                waitStages.push_back(wait.stages);
+            }
+
+            std::vector<VkSemaphore> allSignalSemaphores = signalSemaphores;
+            std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+            submitInfo.pCommandBuffers = commandBuffers.data();
+
+            VkTimelineSemaphoreSubmitInfo timelineInfo{};
+            VkFence fence = VK_NULL_HANDLE;
+
+            if (timelineMode_) {
+                allSignalSemaphores.push_back(semaphore_);
+                signalValues.push_back(value);
+
+                //The values of the binary semaphores are ignored
+                timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+                timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+                timelineInfo.pWaitSemaphoreValues = waitValues.data();
+                timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+                timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+                submitInfo.pNext = &timelineInfo;
+            }
+            else {
+                fence = getFence();
+            }
+
+            submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+            submitInfo.pWaitSemaphores = waitSemaphores.data();
+            submitInfo.pWaitDstStageMask = waitStages.data();
+
+            submitInfo.signalSemaphoreCount = static_cast<uint32_t>(allSignalSemaphores.size());
+            submitInfo.pSignalSemaphores = allSignalSemaphores.data();
+
+            if (vkQueueSubmit(queue_, 1, &submitInfo, fence) != VK_SUCCESS) {
+                if (fence) freeFences_.push_back(fence);
+                throw std::runtime_error("Failed to submit command buffer !");
+            }
+
+            if (fence) pendingFences_.emplace_back(value, fence);
+
+            lastSubmittedValue_ = value;
+            return value;
+
+        }
+
+        //Wait on another queue until value is completed on this timeline. Timeline mode only, binary semaphores are needed otherwise
+        Wait waitFor(uint64_t value, VkPipelineStageFlags stages) const {
+            if (!timelineMode_) {
+                throw std::runtime_error("Waiting a timeline value require timeline semaphores !");
+            }
+
+            return {semaphore_, value, stages};
+        }
+
+        uint64_t getLastSubmittedValue() const {
+            return lastSubmittedValue_;
+        }
+
+        //All the submissions up to this value are finished
+        uint64_t getCompletedValue() {
+
+            if (timelineMode_) {
+                vkGetSemaphoreCounterValue(devicePtr_, semaphore_, &completedValue_);
+                return completedValue_;
+            }
+
+            //A queue finishes its submissions in order
+            while (!pendingFences_.empty() && vkGetFenceStatus(devicePtr_, pendingFences_.front().second) == VK_SUCCESS) {
+                retireOldestFence();
+            }
+
+            return completedValue_;
+
+        }
+
+        //Cheap when the value is already known as completed
+        bool isCompleted(uint64_t value) {
+            return value <= completedValue_ || value <= getCompletedValue();
+        }
+
+        void wait(uint64_t value) {
+
+            if (value <= completedValue_) return;
+
+            if (value > lastSubmittedValue_) {
+                throw std::runtime_error("Waiting a timeline value never submitted !");
+            }
+
+            if (timelineMode_) {
+                VkSemaphoreWaitInfo waitInfo{};
+                waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+                waitInfo.semaphoreCount = 1;
+                waitInfo.pSemaphores = &semaphore_;
+                waitInfo.pValues = &value;
+
+                vkWaitSemaphores(devicePtr_, &waitInfo, UINT64_MAX);
+                completedValue_ = std::max(completedValue_, value);
+                return;
+            }
+
+            while (completedValue_ < value) {
+                vkWaitForFences(devicePtr_, 1, &pendingFences_.front().second, VK_TRUE, UINT64_MAX);
+                retireOldestFence();
+            }
+
+        }
+
+        void waitIdle() {
+            wait(lastSubmittedValue_);
+        }
+
+        bool usesTimelineSemaphore() const {
+            return timelineMode_;
+        }
+
+        VkQueue getQueue() const {
+            return queue_;
+        }
+
+    private:
+
+        void initializeTimelineSemaphore() {
+
+            VkSemaphoreTypeCreateInfo typeInfo{};
+            typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            typeInfo.initialValue = 0;
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphoreInfo.pNext = &typeInfo;
+
+            if (vkCreateSemaphore(devicePtr_, &semaphoreInfo, nullptr, &semaphore_) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create timeline semaphore !");
+            }
+
+        }
+
+        //Fallback mode
+        VkFence getFence() {
+
+            if (!freeFences_.empty()) {
+                VkFence fence = freeFences_.back();
+                freeFences_.pop_back();
+                return fence;
+            }
+
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            VkFence fence;
+            if (vkCreateFence(devicePtr_, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create fence !");
+            }
+
+            return fence;
+
+        }
+
+        void retireOldestFence() {
+            auto [value, fence] = pendingFences_.front();
+            pendingFences_.pop_front();
+
+            vkResetFences(devicePtr_, 1, &fence);
+            freeFences_.push_back(fence);
+
+            completedValue_ = value;
+        }
+
+        VkDevice devicePtr_;
+        VkQueue queue_;
+        bool timelineMode_;
+
+        uint64_t lastSubmittedValue_ = 0;
+        uint64_t completedValue_ = 0;
+
+        //Timeline mode
+        VkSemaphore semaphore_ = VK_NULL_HANDLE;
+
+        //Fallback mode: the fences of the submissions not known as finished, in submission order
+        std::deque<std::pair<uint64_t, VkFence>> pendingFences_;
+        std::vector<VkFence> freeFences_;
+
+};
@@ -8,8 +8,13 @@
 #include <VulkanObjects/RenderPass.hpp>
 #include <VulkanObjects/VertexData.hpp>
 #include <VulkanObjects/Shader.hpp>
+#include <VulkanObjects/ShaderModuleCache.hpp>
+#include <VulkanObjects/PipelineStateCache.hpp>
 #include <VulkanObjects/Helper/ShaderHelper.hpp>
 
+#include <atomic>
+#include <exception>
+
 
 class GraphicsPipeline {
 
@@ -17,32 +22,48 @@ class GraphicsPipeline {
 
         GraphicsPipeline() {};
 
-        GraphicsPipeline(Device const& device, Shader const& shader, VkExtent2D const& swapChainExtent, RenderPass const& renderPass, std::vector<uint32_t> const& vertexAttributesSize, bool depthCheck = false) : devicePtr_(device.get()), shaderPtr_(&shader), vertexAttributesSize_(vertexAttributesSize), depthCheck_(depthCheck) {
-            initialize(swapChainExtent, renderPass);
+        //The viewport and the scissor are dynamic, so the pipeline doesn't depend on the extent.
+        //The VkPipeline is shared with the other GraphicsPipelines having the same state
+        GraphicsPipeline(Device const& device, ShaderModuleCache& shaderModuleCache, PipelineStateCache& pipelineStateCache, Shader const& shader, RenderPass const& renderPass, std::vector<uint32_t> const& vertexAttributesSize, PipelineFixedState const& fixedState = {}, PipelineSpecialization const& specialization = {}) : devicePtr_(device.get()), pipelineCache_(device.getPipelineCache()), shaderModuleCache_(&shaderModuleCache), pipelineStateCache_(&pipelineStateCache), shaderPtr_(&shader), vertexAttributesSize_(vertexAttributesSize), fixedState_(fixedState), specialization_(specialization) {
+            initialize(renderPass);
         }
 
+        //Not built yet: initialize must be called later, possibly from another thread.
+        //Until then, bind use the fallback pipeline if any (it must use a compatible layout) or wait the end of the build.
+        GraphicsPipeline(Device const& device, ShaderModuleCache& shaderModuleCache, PipelineStateCache& pipelineStateCache, Shader const& shader, std::vector<uint32_t> const& vertexAttributesSize, PipelineFixedState const& fixedState, PipelineSpecialization const& specialization, GraphicsPipeline const* fallback = nullptr) : devicePtr_(device.get()), pipelineCache_(device.getPipelineCache()), shaderModuleCache_(&shaderModuleCache), pipelineStateCache_(&pipelineStateCache), shaderPtr_(&shader), vertexAttributesSize_(vertexAttributesSize), fixedState_(fixedState), specialization_(specialization), fallback_(fallback) {}
+
         ~GraphicsPipeline() {
             clean();
         }
 
         void clean() {
-            if (graphicsPipeline_) vkDestroyPipeline(devicePtr_, graphicsPipeline_, nullptr);
+            VkPipeline pipeline = release();
+            if (pipeline) vkDestroyPipeline(devicePtr_, pipeline, nullptr);
         }
 
-        GraphicsPipeline(GraphicsPipeline&& movedPipeline) : devicePtr_(std::move(movedPipeline.devicePtr_)), graphicsPipeline_(std::move(movedPipeline.graphicsPipeline_)) {
+        GraphicsPipeline(GraphicsPipeline&& movedPipeline) : devicePtr_(std::move(movedPipeline.devicePtr_)), pipelineCache_(movedPipeline.pipelineCache_), shaderModuleCache_(movedPipeline.shaderModuleCache_), pipelineStateCache_(movedPipeline.pipelineStateCache_), shaderPtr_(movedPipeline.shaderPtr_), vertexAttributesSize_(std::move(movedPipeline.vertexAttributesSize_)), fixedState_(movedPipeline.fixedState_), specialization_(std::move(movedPipeline.specialization_)), fallback_(movedPipeline.fallback_), stateKey_(std::move(movedPipeline.stateKey_)), graphicsPipeline_(std::move(movedPipeline.graphicsPipeline_)), state_(movedPipeline.state_.load()), buildError_(movedPipeline.buildError_) {
             movedPipeline.graphicsPipeline_ = nullptr;
         }
 
         GraphicsPipeline& operator=(GraphicsPipeline&& movedPipeline) {
             
-            if (graphicsPipeline_) vkDestroyPipeline(devicePtr_, graphicsPipeline_, nullptr);
+            clean();
 
             devicePtr_ = std::move(movedPipeline.devicePtr_);
+            pipelineCache_ = movedPipeline.pipelineCache_;
+            shaderModuleCache_ = movedPipeline.shaderModuleCache_;
+            pipelineStateCache_ = movedPipeline.pipelineStateCache_;
             
             shaderPtr_ = std::move(movedPipeline.shaderPtr_);
             vertexAttributesSize_ = std::move(movedPipeline.vertexAttributesSize_);
+            fixedState_ = movedPipeline.fixedState_;
+            specialization_ = std::move(movedPipeline.specialization_);
+            fallback_ = movedPipeline.fallback_;
 
+            stateKey_ = std::move(movedPipeline.stateKey_);
             graphicsPipeline_ = std::move(movedPipeline.graphicsPipeline_);
+            state_ = movedPipeline.state_.load();
+            buildError_ = movedPipeline.buildError_;
 
             movedPipeline.graphicsPipeline_ = nullptr;
 
@@ -52,13 +73,96 @@ class GraphicsPipeline {
         GraphicsPipeline(const GraphicsPipeline&) = delete;
         GraphicsPipeline& operator=(const GraphicsPipeline&) = delete;
 
-        void initialize(VkExtent2D const& swapChainExtent, RenderPass const& renderPass) {
+        void initialize(RenderPass const& renderPass) {
             
-            std::vector<char> vertShaderCode = ShaderHelper::readFile(shaderPtr_->getVertexFilename());
-            std::vector<char> fragShaderCode = ShaderHelper::readFile(shaderPtr_->getFragmentFilename());
+            //The modules are shared with the other pipelines, the files are only read the first time
+            VkShaderModule vertShaderModule = shaderModuleCache_->get(shaderPtr_->getVertexFilename());
+            VkShaderModule fragShaderModule = shaderModuleCache_->get(shaderPtr_->getFragmentFilename());
+
+            //The constants of the pipeline override the defaults of the shader
+            PipelineSpecialization specialization = shaderPtr_->getSpecialization();
+            specialization.vertex.merge(specialization_.vertex);
+            specialization.fragment.merge(specialization_.fragment);
+
+            stateKey_ = {vertShaderModule, fragShaderModule, shaderPtr_->getPipelineLayout(), vertexAttributesSize_, fixedState_, specialization, renderPass.getColorFormat(), renderPass.getDepthFormat()};
+
+            //Only created if no other GraphicsPipeline has the same state
+            graphicsPipeline_ = pipelineStateCache_->acquire(stateKey_, [&]() { return createPipeline(vertShaderModule, fragShaderModule, specialization, renderPass); });
+
+            //Publish the pipeline to the threads waiting it
+            state_.store(READY, std::memory_order_release);
+            state_.notify_all();
+
+        }
+
+        void bind(VkCommandBuffer commandBuffer) const {
+
+            if (!isReady()) {
+                if (fallback_) {
+                    fallback_->bind(commandBuffer);
+                    return;
+                }
+
+                //No fallback, wait the end of the build
+                waitBuilt();
+            }
 
-            VkShaderModule vertShaderModule = ShaderHelper::createShaderModule(devicePtr_, vertShaderCode);
-            VkShaderModule fragShaderModule = ShaderHelper::createShaderModule(devicePtr_, fragShaderCode);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_);
+        }
+
+        //// Asynchronous build
+
+        bool isReady() const {
+            return state_.load(std::memory_order_acquire) == READY;
+        }
+
+        //Rethrow the error of the build if it failed
+        void waitBuilt() const {
+            state_.wait(PENDING, std::memory_order_acquire);
+
+            if (state_.load(std::memory_order_acquire) == FAILED) {
+                std::rethrow_exception(buildError_);
+            }
+        }
+
+        //Called by the building thread when initialize throw
+        void setBuildError(std::exception_ptr error) {
+            buildError_ = error;
+            state_.store(FAILED, std::memory_order_release);
+            state_.notify_all();
+        }
+
+        void setFallback(GraphicsPipeline const* fallback) {
+            fallback_ = fallback;
+        }
+
+        VkPipeline get() const {
+            return graphicsPipeline_;
+        }
+
+        PipelineStateKey const& getStateKey() const {
+            return stateKey_;
+        }
+
+        //Give up the pipeline. Return it if no other GraphicsPipeline shares it, to destroy it later
+        VkPipeline release() {
+            VkPipeline pipeline = graphicsPipeline_;
+            graphicsPipeline_ = VK_NULL_HANDLE;
+            state_.store(PENDING, std::memory_order_release);
+
+            if (pipeline && pipelineStateCache_) return pipelineStateCache_->release(stateKey_);
+            return pipeline;
+        }
+
+    private:
+
+        VkPipeline createPipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, PipelineSpecialization const& specialization, RenderPass const& renderPass) const {
+
+            //Constants folded by the driver when compiling the stages
+            SpecializationConstants::Info vertSpecializationInfo;
+            SpecializationConstants::Info fragSpecializationInfo;
+            specialization.vertex.fill(vertSpecializationInfo);
+            specialization.fragment.fill(fragSpecializationInfo);
 
             // Vertex hader
             VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -67,7 +171,7 @@ class GraphicsPipeline {
 
             vertShaderStageInfo.module = vertShaderModule;
             vertShaderStageInfo.pName = "main";
-            vertShaderStageInfo.pSpecializationInfo = nullptr;
+            vertShaderStageInfo.pSpecializationInfo = specialization.vertex.empty() ? nullptr : &vertSpecializationInfo.info;
 
             // Fragment Shader
             VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
@@ -76,7 +180,7 @@ class GraphicsPipeline {
 
             fragShaderStageInfo.module = fragShaderModule;
             fragShaderStageInfo.pName = "main";
-            fragShaderStageInfo.pSpecializationInfo = nullptr;
+            fragShaderStageInfo.pSpecializationInfo = specialization.fragment.empty() ? nullptr : &fragSpecializationInfo.info;
 
             // Dynamic shaders array
             VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
@@ -101,30 +205,17 @@ class GraphicsPipeline {
             /// Describe how to link vertices together (We can change to line here for example)
             VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
             inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-            inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            inputAssembly.topology = fixedState_.topology;
             inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-            /// Viewport. It describe where we should draw on the frameBuffer
-            VkViewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = (float) swapChainExtent.width;
-            viewport.height = (float) swapChainExtent.height;
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-
-            // Mask filter, only the pixels within will be drawn
-            VkRect2D scissor{};
-            scissor.offset = {0, 0};
-            scissor.extent = swapChainExtent;
-
-            // Merging viewport and scissor to create one unique viewport
+            /// Viewport (where we should draw on the frameBuffer) and scissor (mask filter, only the pixels within will be drawn)
+            // Both are dynamic states set when recording, only their count is given here
             VkPipelineViewportStateCreateInfo viewportState{};
             viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
             viewportState.viewportCount = 1;
-            viewportState.pViewports = &viewport;
+            viewportState.pViewports = nullptr;
             viewportState.scissorCount = 1;
-            viewportState.pScissors = &scissor;
+            viewportState.pScissors = nullptr;
 
             /// Rasterizer
             VkPipelineRasterizationStateCreateInfo rasterizer{};
@@ -137,13 +228,12 @@ class GraphicsPipeline {
              * VK_POLYGON_MODE_LINE : Only draw lines
              * VK_POLYGON_MODE_POINT : Only draw points
              */
-            rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+            rasterizer.polygonMode = fixedState_.polygonMode;
 
             rasterizer.lineWidth = 1.0f; //Define the thickness of the lines. If not 1.0, the extension "wideLines" should be activated
 
-            rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-            rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //Clockwise or not to evaluate front face
-            // rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE; //Clockwise or not to evaluate front face
+            rasterizer.cullMode = fixedState_.cullMode;
+            rasterizer.frontFace = fixedState_.frontFace; //Clockwise or not to evaluate front face
 
             //Parameters to alter the depth
             rasterizer.depthBiasEnable = VK_FALSE;
@@ -167,16 +257,15 @@ class GraphicsPipeline {
             /// Color blending (Configure how we combine colors that are already present in the framebuffer)
 
             // One per framebuffer
-            // Deactivated :
             VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-            colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-            colorBlendAttachment.blendEnable = VK_FALSE;
-            colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-            colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-            colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-            colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-            colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-            colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
+            colorBlendAttachment.colorWriteMask = fixedState_.colorWriteMask;
+            colorBlendAttachment.blendEnable = fixedState_.blendEnable ? VK_TRUE : VK_FALSE;
+            colorBlendAttachment.srcColorBlendFactor = fixedState_.srcColorBlendFactor;
+            colorBlendAttachment.dstColorBlendFactor = fixedState_.dstColorBlendFactor;
+            colorBlendAttachment.colorBlendOp = fixedState_.colorBlendOp;
+            colorBlendAttachment.srcAlphaBlendFactor = fixedState_.srcAlphaBlendFactor;
+            colorBlendAttachment.dstAlphaBlendFactor = fixedState_.dstAlphaBlendFactor;
+            colorBlendAttachment.alphaBlendOp = fixedState_.alphaBlendOp;
 
             // Global color blend settings
             VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -193,16 +282,20 @@ class GraphicsPipeline {
             colorBlending.blendConstants[3] = 0.0f; // Optional
 
             std::vector<VkDynamicState> dynamicStates = {
-                VK_DYNAMIC_STATE_VIEWPORT
+                VK_DYNAMIC_STATE_VIEWPORT,
+                VK_DYNAMIC_STATE_SCISSOR
             };
 
+            //Required by the render passes with a depth attachment
+            bool hasDepthAttachment = renderPass.getDepthFormat() != VK_FORMAT_UNDEFINED;
+
             VkPipelineDepthStencilStateCreateInfo depthStencil{};
-            if (depthCheck_) {
+            if (hasDepthAttachment) {
                 depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-                depthStencil.depthTestEnable = VK_TRUE;
-                depthStencil.depthWriteEnable = VK_TRUE;
+                depthStencil.depthTestEnable = fixedState_.depthTest ? VK_TRUE : VK_FALSE;
+                depthStencil.depthWriteEnable = fixedState_.depthWrite ? VK_TRUE : VK_FALSE;
             
-                depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+                depthStencil.depthCompareOp = fixedState_.depthCompareOp;
 
                 depthStencil.depthBoundsTestEnable = VK_FALSE;
                 // depthStencil.minDepthBounds = 0.0f; // Optionnel
@@ -245,7 +338,7 @@ class GraphicsPipeline {
             pipelineInfo.pRasterizationState = &rasterizer;
             pipelineInfo.pMultisampleState = &multisampling;
             
-            pipelineInfo.pDepthStencilState = depthCheck_ ? &depthStencil : nullptr;
+            pipelineInfo.pDepthStencilState = hasDepthAttachment ? &depthStencil : nullptr;
             
             pipelineInfo.pColorBlendState = &colorBlending;
             pipelineInfo.pDynamicState = &dynamicState; // Optional
@@ -258,33 +351,40 @@ class GraphicsPipeline {
             pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
             pipelineInfo.basePipelineIndex = -1; // Optional
 
-            if (vkCreateGraphicsPipelines(devicePtr_, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline_) != VK_SUCCESS) {
+            VkPipeline pipeline;
+            if (vkCreateGraphicsPipelines(devicePtr_, pipelineCache_, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to create the graphic pipeline !");
             }
 
-            //Now delete the shader modules since we don't need them anymore
-            vkDestroyShaderModule(devicePtr_, fragShaderModule, nullptr);
-            vkDestroyShaderModule(devicePtr_, vertShaderModule, nullptr);
+            return pipeline;
 
         }
 
-        void bind(VkCommandBuffer commandBuffer) const {
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_);
-        }
-
-        VkPipeline get() const {
-            return graphicsPipeline_;
-        }
-
-    private:
         VkDevice devicePtr_;
+        VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
+        ShaderModuleCache* shaderModuleCache_ = nullptr;
+        PipelineStateCache* pipelineStateCache_ = nullptr;
 
         //Parameter saved
         const Shader* shaderPtr_;
         std::vector<uint32_t> vertexAttributesSize_;
-        
-        bool depthCheck_;
 
+        PipelineFixedState fixedState_;
+        PipelineSpecialization specialization_;
+
+        //Bound while this pipeline is not built
+        GraphicsPipeline const* fallback_ = nullptr;
+
+        //Key of graphicsPipeline_ in the state cache
+        PipelineStateKey stateKey_;
         VkPipeline graphicsPipeline_ = VK_NULL_HANDLE;
 
+        //Build state, written by the building thread
+        static constexpr uint8_t PENDING = 0;
+        static constexpr uint8_t READY = 1;
+        static constexpr uint8_t FAILED = 2;
+
+        mutable std::atomic<uint8_t> state_ = PENDING;
+        std::exception_ptr buildError_;
+
 };
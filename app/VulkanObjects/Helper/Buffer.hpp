@@ -6,6 +6,7 @@
 #include <VulkanObjects/Allocator.hpp>
 #include <VulkanObjects/Helper/Command.hpp>
 
+#include <vector>
 #include <stdexcept>
 
 
@@ -65,11 +66,18 @@ class Buffer {
 
         }
 
-        static void create(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocationCreateFlags flags, VkBuffer& buffer, VmaAllocation& bufferAllocation, VmaAllocationInfo* bufferAllocInfo) {
+        //With more than one queue family, the buffer can be used by all of them without ownership transfers (concurrent sharing)
+        static void create(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocationCreateFlags flags, VkBuffer& buffer, VmaAllocation& bufferAllocation, VmaAllocationInfo* bufferAllocInfo, std::vector<uint32_t> const& queueFamilies = {}) {
             VkBufferCreateInfo bufCreateInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
             bufCreateInfo.size = size;
             bufCreateInfo.usage = usage;
             bufCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if (queueFamilies.size() > 1) {
+                bufCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                bufCreateInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+                bufCreateInfo.pQueueFamilyIndices = queueFamilies.data();
+            }
             
             VmaAllocationCreateInfo allocCreateInfo = {};
             allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
@@ -125,22 +133,38 @@ class Buffer {
 
             VkCommandBuffer commandBuffer = Command::beginSingleTimeCommands(device, commandPool);
 
+            recordCopy(commandBuffer, srcBuffer, dstBuffer, size);
+
+            // End recording
+            Command::endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+        }
+
+        //Only record the copy, to batch it with others in the same command buffer
+        static void recordCopy(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0) {
+
             VkBufferCopy copyRegion{};
-            // copyRegion.srcOffset = 0; // Optional
-            // copyRegion.dstOffset = 0; // Optional
+            copyRegion.srcOffset = srcOffset;
+            copyRegion.dstOffset = dstOffset;
             copyRegion.size = size;
             vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
-            // End recording
-            Command::endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
         }
 
         static void copyToImage(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
             
             VkCommandBuffer commandBuffer = Command::beginSingleTimeCommands(device, commandPool);
 
+            recordCopyToImage(commandBuffer, buffer, image, width, height);
+
+            Command::endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+
+        }
+
+        //Only record the copy, the image must be in the VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL layout
+        static void recordCopyToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0) {
+
             VkBufferImageCopy region{};
-            region.bufferOffset = 0;
+            region.bufferOffset = bufferOffset;
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
 
@@ -165,8 +189,6 @@ class Buffer {
                 &region
             );
 
-            Command::endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
-
 	}
 
 };
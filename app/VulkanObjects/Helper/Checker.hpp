@@ -63,7 +63,7 @@ class Checker {
 
         }
 
-        static bool deviceExtensionSupport(VkPhysicalDevice physicalDevice) {
+        static bool deviceExtensionSupport(VkPhysicalDevice physicalDevice, std::vector<const char*> const& requiredExtensions = deviceExtensions) {
             
             uint32_t extensionCount;
             vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
@@ -75,7 +75,7 @@ class Checker {
             for ( VkExtensionProperties const& extension : availableExtensions )
                 availableStringVector.emplace_back(extension.extensionName);
 
-            return verifyAvailability(deviceExtensions, availableStringVector);
+            return verifyAvailability(requiredExtensions, availableStringVector);
 
         }
 
@@ -10,12 +10,17 @@ class Getter {
 
     public:
 
-        static std::vector<const char*> requiredExtensions(bool enableValidationLayers) {
-            uint32_t glfwExtensionCount = 0;
-            const char** glfwExtensions;
-            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        static std::vector<const char*> requiredExtensions(bool enableValidationLayers, bool headless = false) {
+            std::vector<const char*> extensions;
 
-            std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            //Headless instances don't present to a window, so they don't need the GLFW surface extensions
+            if (!headless) {
+                uint32_t glfwExtensionCount = 0;
+                const char** glfwExtensions;
+                glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+                extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            }
 
             if (enableValidationLayers) {
                 extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -25,6 +30,16 @@ class Getter {
         }
 
 
+        //Highest Vulkan version supported by the loader, vkEnumerateInstanceVersion doesn't exist in Vulkan 1.0 loaders
+        static uint32_t instanceVersion() {
+            auto enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion) vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion");
+
+            uint32_t version = VK_API_VERSION_1_0;
+            if (enumerateInstanceVersion) enumerateInstanceVersion(&version);
+
+            return version;
+        }
+
         static std::vector<VkExtensionProperties> availableExtensions() {
 
             uint32_t extensionCount = 0;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+//FNV-1a, used by the caches to index their content
+class Hash {
+
+    public:
+
+        static constexpr uint64_t BASIS = 14695981039346656037ull;
+
+        static uint64_t bytes(const void* data, size_t size, uint64_t hash = BASIS) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+        //Add a value (integer, enum, handle) to the hash
+        template<typename T>
+        static void combine(uint64_t& hash, T const& value) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be hashed byte per byte");
+            hash = bytes(&value, sizeof(T), hash);
+        }
+
+};
@@ -12,6 +12,37 @@ class Image {
 
     public:
 
+        //Bytes per texel of the uncompressed color formats usable as render targets, throw for the others
+        static uint32_t getTexelSize(VkFormat format) {
+
+            switch (format) {
+                case VK_FORMAT_R8_UNORM:
+                case VK_FORMAT_R8_SRGB:
+                    return 1;
+                case VK_FORMAT_R8G8_UNORM:
+                case VK_FORMAT_R16_SFLOAT:
+                    return 2;
+                case VK_FORMAT_R8G8B8A8_UNORM:
+                case VK_FORMAT_R8G8B8A8_SRGB:
+                case VK_FORMAT_B8G8R8A8_UNORM:
+                case VK_FORMAT_B8G8R8A8_SRGB:
+                case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+                case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+                case VK_FORMAT_R16G16_SFLOAT:
+                case VK_FORMAT_R32_SFLOAT:
+                    return 4;
+                case VK_FORMAT_R16G16B16A16_UNORM:
+                case VK_FORMAT_R16G16B16A16_SFLOAT:
+                case VK_FORMAT_R32G32_SFLOAT:
+                    return 8;
+                case VK_FORMAT_R32G32B32A32_SFLOAT:
+                    return 16;
+                default:
+                    throw std::runtime_error("Unsupported color format !");
+            }
+
+        }
+
         static VkImageView createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
             
             VkImageViewCreateInfo viewInfo{};
@@ -39,6 +70,15 @@ class Image {
 
             VkCommandBuffer commandBuffer = Command::beginSingleTimeCommands(device, commandPool);
 
+            recordTransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout);
+
+            Command::endSingleTimeCommands(device, commandPool, queue, commandBuffer);
+        
+        }
+
+        //Only record the barrier, to batch it with others in the same command buffer
+        static void recordTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+
             VkImageMemoryBarrier barrier{};
             barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             barrier.oldLayout = oldLayout;
@@ -87,8 +127,6 @@ class Image {
                 1, &barrier
             );
 
-            Command::endSingleTimeCommands(device, commandPool, queue, commandBuffer);
-        
         }
 
 };
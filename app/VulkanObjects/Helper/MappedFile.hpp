@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+//Read-only memory mapping of a whole file, the data are paged in by the OS instead of being copied through a stream
+class MappedFile {
+
+    public:
+        MappedFile(std::string const& filename) {
+
+#ifdef _WIN32
+            file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error(std::string {"failed to open file "} + filename + " !");
+            }
+
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx(file_, &fileSize);
+            size_ = static_cast<size_t>(fileSize.QuadPart);
+
+            //A mapping of an empty file is not allowed
+            if (size_ == 0) return;
+
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+#else
+            int fileDescriptor = open(filename.c_str(), O_RDONLY);
+            if (fileDescriptor < 0) {
+                throw std::runtime_error(std::string {"failed to open file "} + filename + " !");
+            }
+
+            struct stat fileStatus;
+            fstat(fileDescriptor, &fileStatus);
+            size_ = static_cast<size_t>(fileStatus.st_size);
+
+            if (size_ > 0) {
+                data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+                if (data_ == MAP_FAILED) data_ = nullptr;
+            }
+
+            //The mapping stay valid after closing the file
+            close(fileDescriptor);
+#endif
+
+            if (size_ > 0 && !data_) {
+                unmap();
+                throw std::runtime_error(std::string {"failed to map file "} + filename + " !");
+            }
+
+        }
+
+        ~MappedFile() {
+            unmap();
+        }
+
+        MappedFile(MappedFile&&) = delete; //TODO: Declarer un move constructor
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        //Page aligned, so it can be read as uint32_t words
+        const void* data() const {
+            return data_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+
+        void unmap() {
+#ifdef _WIN32
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_) munmap(data_, size_);
+#endif
+            data_ = nullptr;
+        }
+
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#endif
+
+        void* data_ = nullptr;
+        size_t size_ = 0;
+
+};
@@ -70,15 +70,18 @@ class PhysicalDevices {
                 return 0;
             }
 
+            //Without surface we render offscreen, so there is no presentation or swap chain to check
+            bool headless = surface == VK_NULL_HANDLE;
+
             // We verify that the device have access to a graphic family queue.
             QueueFamily::QueueFamilyIndices indices = QueueFamily::findQueueFamilies(device, surface);
-            if (!indices.isComplete()) {
+            if (!indices.isComplete(!headless)) {
                 return 0;
             }
 
-            bool extensionsSupported = Checker::deviceExtensionSupport(device);
-            bool swapChainAdequate = false;
-            if (extensionsSupported) {
+            bool extensionsSupported = Checker::deviceExtensionSupport(device, headless ? headlessDeviceExtensions : deviceExtensions);
+            bool swapChainAdequate = headless;
+            if (extensionsSupported && !headless) {
                 SwapChainHelper::SwapChainSupportDetails swapChainSupport = SwapChainHelper::querySwapChainSupport(device, surface);
                 swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
             }
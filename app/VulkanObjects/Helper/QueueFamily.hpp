@@ -13,12 +13,20 @@ class QueueFamily {
             std::optional<uint32_t> graphicsFamily;
             std::optional<uint32_t> presentFamily;
 
-            bool isComplete() {
-                return graphicsFamily.has_value() && presentFamily.has_value();
+            //Only set if a family other than the graphics one can do transfers
+            std::optional<uint32_t> transferFamily;
+
+            //Only set if a family without graphics can do compute (async compute)
+            std::optional<uint32_t> computeFamily;
+
+            //Headless devices have no surface, so the present family isn't required for them
+            bool isComplete(bool presentRequired = true) const {
+                return graphicsFamily.has_value() && (presentFamily.has_value() || !presentRequired);
             }
         };
 
         //This function require the device to retrieve the queue families from and a surface to verify the capability of the queues to present to the surface 
+        //If surface is VK_NULL_HANDLE (headless), the present family is not searched
         static QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface) {
 
             QueueFamilyIndices indices;
@@ -32,23 +40,73 @@ class QueueFamily {
                     indices.graphicsFamily = i;
                 }
 
-                VkBool32 presentSupport = false;
-                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+                if (surface != VK_NULL_HANDLE) {
+                    VkBool32 presentSupport = false;
+                    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-                if (presentSupport) {
-                    indices.presentFamily = i;
+                    if (presentSupport) {
+                        indices.presentFamily = i;
+                    }
                 }
 
 
-                if (indices.isComplete()) {
+                if (indices.isComplete(surface != VK_NULL_HANDLE)) {
                     break;
                 }
 
             }
+
+            if (indices.graphicsFamily) {
+                indices.transferFamily = findTransferFamily(queueFamilies, indices.graphicsFamily.value());
+                indices.computeFamily = findComputeFamily(queueFamilies);
+            }
             
             return indices;
         }
 
+        //Prefer a transfer only family (usually DMA engines), then any other family able to do transfers
+        static std::optional<uint32_t> findTransferFamily(std::vector<VkQueueFamilyProperties> const& queueFamilies, uint32_t graphicsFamily) {
+
+            std::optional<uint32_t> separateFamily;
+
+            for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
+
+                if (i == graphicsFamily) continue;
+
+                VkQueueFlags flags = queueFamilies[i].queueFlags;
+
+                if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                    return i;
+                }
+
+                //Note: graphics and compute families implicitly support transfers
+                if (!separateFamily && (flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                    separateFamily = i;
+                }
+
+            }
+
+            return separateFamily;
+
+        }
+
+        //A compute family without graphics (usually the async compute engines) runs in parallel of the graphics queue
+        static std::optional<uint32_t> findComputeFamily(std::vector<VkQueueFamilyProperties> const& queueFamilies) {
+
+            for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
+
+                VkQueueFlags flags = queueFamilies[i].queueFlags;
+
+                if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+                    return i;
+                }
+
+            }
+
+            return std::nullopt;
+
+        }
+
         //Get all available queues in the device
         static std::vector<VkQueueFamilyProperties> getQueueFamilies(VkPhysicalDevice device) {
 
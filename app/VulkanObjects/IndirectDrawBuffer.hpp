@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/MeshArena.hpp>
+#include <VulkanObjects/Helper/Buffer.hpp>
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+//Indexed indirect draw commands, one region per frame in flight in a persistently mapped buffer.
+//The commands are written on the CPU (push) or by a compute shader (storage buffer), then all drawn with one call.
+//The buffer is only mapped for the CPU written commands, the one written by a compute shader stays in device local memory.
+//Region of a frame: the draw count (uint32_t, padded to COMMANDS_OFFSET) followed by the VkDrawIndexedIndirectCommand array.
+//GLSL: buffer DrawCommands { uint count; uint pad0; uint pad1; uint pad2; DrawIndexedIndirectCommand commands[]; }
+class IndirectDrawBuffer {
+
+    public:
+
+        static constexpr VkDeviceSize COMMANDS_OFFSET = 16;
+        static constexpr VkDeviceSize COMMAND_SIZE = sizeof(VkDrawIndexedIndirectCommand);
+
+        //gpuWritten: the commands are written by a compute shader (FrustumCuller...), push and flush are not available
+        IndirectDrawBuffer(Device const& device, uint16_t framesInFlight, uint32_t maxDraws, bool gpuWritten = false)
+            : allocator_(device.getAllocator()), multiDrawIndirect_(device.supportsMultiDrawIndirect()), drawIndirectCount_(device.supportsDrawIndirectCount()),
+              gpuWritten_(gpuWritten), maxDraws_(maxDraws), drawCounts_(framesInFlight, 0) {
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device.getPhysical(), &properties);
+
+            //The region of a frame can be bound as a storage buffer
+            VkDeviceSize alignment = std::max<VkDeviceSize>(COMMANDS_OFFSET, properties.limits.minStorageBufferOffsetAlignment);
+            frameSize_ = (COMMANDS_OFFSET + COMMAND_SIZE * maxDraws_ + alignment - 1) / alignment * alignment;
+
+            //Written and read by the GPU every frame, the host memory would be used without resizable BAR
+            VmaAllocationCreateFlags allocationFlags = gpuWritten_ ? 0 : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+            VmaAllocationInfo allocationInfo;
+            Buffer::create(allocator_, frameSize_ * framesInFlight, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, allocationFlags, buffer_, allocation_, &allocationInfo);
+
+            mapped_ = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        }
+
+        ~IndirectDrawBuffer() {
+            vmaDestroyBuffer(allocator_, buffer_, allocation_);
+        }
+
+        IndirectDrawBuffer(IndirectDrawBuffer&&) = delete; //TODO: Declarer un move constructor
+        IndirectDrawBuffer& operator=(IndirectDrawBuffer&&) = delete;
+
+        IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+        IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+
+        //The GPU must be done with the previous use of this frame
+        void beginFrame(uint32_t frameIndex) {
+            currentFrame_ = frameIndex;
+            drawCounts_[frameIndex] = 0;
+        }
+
+        //Return the index of the command, usable as gl_DrawID or to find per draw data
+        uint32_t push(VkDrawIndexedIndirectCommand const& command) {
+
+            if (gpuWritten_) {
+                throw std::runtime_error("The commands of this indirect draw buffer are written on the GPU !");
+            }
+
+            uint32_t& drawCount = drawCounts_[currentFrame_];
+            if (drawCount >= maxDraws_) {
+                throw std::runtime_error("Indirect draw buffer is full !");
+            }
+
+            memcpy(mapped_ + getCommandsOffset(currentFrame_) + drawCount * COMMAND_SIZE, &command, COMMAND_SIZE);
+
+            return drawCount++;
+        }
+
+        uint32_t push(MeshArena::Mesh const& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0) {
+            return push({mesh.indexCount, instanceCount, mesh.firstIndex, mesh.vertexOffset, firstInstance});
+        }
+
+        //Write the draw count of the CPU commands and make them visible to the GPU (nothing to do on coherent memory).
+        //Not for a frame whose commands are written on the GPU, the count would be overwritten
+        void flush(uint32_t frameIndex) {
+
+            if (gpuWritten_) {
+                throw std::runtime_error("The commands of this indirect draw buffer are written on the GPU !");
+            }
+
+            memcpy(mapped_ + getCountOffset(frameIndex), &drawCounts_[frameIndex], sizeof(uint32_t));
+            vmaFlushAllocation(allocator_, allocation_, getCountOffset(frameIndex), COMMANDS_OFFSET + drawCounts_[frameIndex] * COMMAND_SIZE);
+        }
+
+        //Draw the commands pushed on the CPU, the vertex and index buffers (a mesh arena) must be bound
+        void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+
+            uint32_t drawCount = drawCounts_[frameIndex];
+            if (drawCount == 0) return;
+
+            if (multiDrawIndirect_) {
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer_, getCommandsOffset(frameIndex), drawCount, static_cast<uint32_t>(COMMAND_SIZE));
+                return;
+            }
+
+            //Without multiDrawIndirect, one call per command
+            for (uint32_t i = 0; i < drawCount; ++i) {
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer_, getCommandsOffset(frameIndex) + i * COMMAND_SIZE, 1, static_cast<uint32_t>(COMMAND_SIZE));
+            }
+
+        }
+
+        //Draw the commands written on the GPU, the count is read from the region of the frame.
+        //Without drawIndirectCount all the maxDraws commands are drawn: the unused ones must have an instanceCount of 0
+        void drawCount(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+
+            if (drawIndirectCount_) {
+                vkCmdDrawIndexedIndirectCount(commandBuffer, buffer_, getCommandsOffset(frameIndex), buffer_, getCountOffset(frameIndex), maxDraws_, static_cast<uint32_t>(COMMAND_SIZE));
+                return;
+            }
+
+            if (multiDrawIndirect_) {
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer_, getCommandsOffset(frameIndex), maxDraws_, static_cast<uint32_t>(COMMAND_SIZE));
+                return;
+            }
+
+            for (uint32_t i = 0; i < maxDraws_; ++i) {
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer_, getCommandsOffset(frameIndex) + i * COMMAND_SIZE, 1, static_cast<uint32_t>(COMMAND_SIZE));
+            }
+
+        }
+
+        VkBuffer getBuffer() const {
+            return buffer_;
+        }
+
+        //Region of the frame, to bind it as a storage buffer
+        VkDescriptorBufferInfo getFrameBufferInfo(uint32_t frameIndex) const {
+            return {buffer_, getCountOffset(frameIndex), frameSize_};
+        }
+
+        VkDeviceSize getCountOffset(uint32_t frameIndex) const {
+            return frameIndex * frameSize_;
+        }
+
+        VkDeviceSize getCommandsOffset(uint32_t frameIndex) const {
+            return frameIndex * frameSize_ + COMMANDS_OFFSET;
+        }
+
+        uint32_t getMaxDraws() const {
+            return maxDraws_;
+        }
+
+        bool isGpuWritten() const {
+            return gpuWritten_;
+        }
+
+        //Commands pushed on the CPU
+        uint32_t getDrawCount(uint32_t frameIndex) const {
+            return drawCounts_[frameIndex];
+        }
+
+    private:
+
+        VmaAllocator allocator_;
+
+        bool multiDrawIndirect_;
+        bool drawIndirectCount_;
+        bool gpuWritten_;
+
+        VkBuffer buffer_ = VK_NULL_HANDLE;
+        VmaAllocation allocation_ = VK_NULL_HANDLE;
+        uint8_t* mapped_ = nullptr;
+
+        uint32_t maxDraws_;
+        VkDeviceSize frameSize_;
+
+        uint32_t currentFrame_ = 0;
+        std::vector<uint32_t> drawCounts_;
+
+};
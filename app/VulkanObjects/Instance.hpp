@@ -16,8 +16,8 @@ class Instance {
 
     public:
 
-        Instance(bool enableValidationLayers = false) {
-            initializeInstance(enableValidationLayers);
+        Instance(bool enableValidationLayers = false, bool headless = false) {
+            initializeInstance(enableValidationLayers, headless);
         }
 
         ~Instance() {
@@ -30,7 +30,7 @@ class Instance {
         Instance(const Instance&) = delete;
         Instance& operator=(const Instance&) = delete;
 
-        void initializeInstance(bool enableValidationLayers) {
+        void initializeInstance(bool enableValidationLayers, bool headless = false) {
             
             if (enableValidationLayers && !Checker::validationLayerSupport())
                 throw std::runtime_error("validation layers requested, but not available!");        
@@ -42,7 +42,9 @@ class Instance {
             appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
             appInfo.pEngineName = "No Engine";
             appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-            appInfo.apiVersion = VK_API_VERSION_1_0;
+            //Vulkan 1.2 if available, for the timeline semaphores
+            apiVersion_ = Getter::instanceVersion() >= VK_API_VERSION_1_2 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+            appInfo.apiVersion = apiVersion_;
 
 
             //Code to get a list of all supported availableExtensions
@@ -53,7 +55,7 @@ class Instance {
             // 	std::cout << '\t' << extension.extensionName << '\n';
             // }
 
-            std::vector<const char*> requiredExtensions = Getter::requiredExtensions(enableValidationLayers);
+            std::vector<const char*> requiredExtensions = Getter::requiredExtensions(enableValidationLayers, headless);
 
             //And verify if the required are availables
             if (Checker::requiredExtensionAreAvailable(requiredExtensions, availableExtensions) == false) {
@@ -91,7 +93,12 @@ class Instance {
             return instance_;
         }
 
+        uint32_t getApiVersion() const {
+            return apiVersion_;
+        }
+
     private:
         VkInstance instance_;
+        uint32_t apiVersion_;
 
 };
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Helper/Hash.hpp>
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+
+//Descriptor set layouts and pipeline layouts shared by all the shaders with the same description.
+//The descriptions are normalized (sorted) before lookup, so the order of the bindings doesn't matter.
+//Two shaders with the same layouts get the same handles: their descriptor sets stay bound when switching pipeline.
+//Thread safe, the layouts live as long as the cache.
+class LayoutCache {
+
+    public:
+
+        LayoutCache(Device const& device) : devicePtr_(device.get()) {};
+
+        ~LayoutCache() {
+            for (auto& [key, pipelineLayout] : pipelineLayouts_) {
+                vkDestroyPipelineLayout(devicePtr_, pipelineLayout, nullptr);
+            }
+            for (auto& [key, setLayout] : setLayouts_) {
+                vkDestroyDescriptorSetLayout(devicePtr_, setLayout, nullptr);
+            }
+        }
+
+        LayoutCache(LayoutCache&&) = delete; //TODO: Declarer un move constructor
+        LayoutCache& operator=(LayoutCache&&) = delete;
+
+        LayoutCache(const LayoutCache&) = delete;
+        LayoutCache& operator=(const LayoutCache&) = delete;
+
+        //bindingFlags is empty or has the flags of each binding (descriptor indexing). The immutable samplers are not supported
+        VkDescriptorSetLayout getSetLayout(std::vector<VkDescriptorSetLayoutBinding> const& unsortedBindings, VkDescriptorSetLayoutCreateFlags flags = 0, std::vector<VkDescriptorBindingFlags> const& unsortedBindingFlags = {}) {
+
+            if (!unsortedBindingFlags.empty() && unsortedBindingFlags.size() != unsortedBindings.size()) {
+                throw std::runtime_error("One binding flags per binding is required !");
+            }
+
+            //Sort the bindings and their flags together
+            std::vector<size_t> order(unsortedBindings.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [&unsortedBindings](size_t a, size_t b) { return unsortedBindings[a].binding < unsortedBindings[b].binding; });
+
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            std::vector<VkDescriptorBindingFlags> bindingFlags;
+
+            SetLayoutKey key;
+            key.flags = flags;
+            for (size_t index : order) {
+                VkDescriptorSetLayoutBinding const& binding = unsortedBindings[index];
+                if (binding.pImmutableSamplers) {
+                    throw std::runtime_error("Immutable samplers are not supported by the layout cache !");
+                }
+
+                VkDescriptorBindingFlags currentFlags = unsortedBindingFlags.empty() ? 0 : unsortedBindingFlags[index];
+
+                bindings.push_back(binding);
+                bindingFlags.push_back(currentFlags);
+                key.bindings.push_back({binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags, currentFlags});
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto found = setLayouts_.find(key);
+            if (found != setLayouts_.end()) return found->second;
+
+            VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+            bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+            bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+            VkDescriptorSetLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.pNext = unsortedBindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+            layoutInfo.flags = flags;
+            layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+            layoutInfo.pBindings = bindings.data();
+
+            VkDescriptorSetLayout setLayout;
+            if (vkCreateDescriptorSetLayout(devicePtr_, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create a descriptor set !");
+            }
+
+            setLayouts_.emplace(std::move(key), setLayout);
+            return setLayout;
+
+        }
+
+        //The set layouts must come from this cache, so equal handles mean equal descriptions
+        VkPipelineLayout getPipelineLayout(std::vector<VkDescriptorSetLayout> const& setLayouts, std::vector<VkPushConstantRange> pushConstantRanges = {}) {
+
+            std::sort(pushConstantRanges.begin(), pushConstantRanges.end(), [](VkPushConstantRange const& a, VkPushConstantRange const& b) { return a.offset < b.offset || (a.offset == b.offset && a.stageFlags < b.stageFlags); });
+
+            PipelineLayoutKey key;
+            key.setLayouts = setLayouts;
+            for (VkPushConstantRange const& range : pushConstantRanges) {
+                key.pushConstantRanges.push_back({range.stageFlags, range.offset, range.size});
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto found = pipelineLayouts_.find(key);
+            if (found != pipelineLayouts_.end()) return found->second;
+
+            VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+            pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+            pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+            pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+            pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+            VkPipelineLayout pipelineLayout;
+            if (vkCreatePipelineLayout(devicePtr_, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create the pipeline layout !");
+            }
+
+            pipelineLayouts_.emplace(std::move(key), pipelineLayout);
+            return pipelineLayout;
+
+        }
+
+        size_t getSetLayoutCount() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return setLayouts_.size();
+        }
+
+        size_t getPipelineLayoutCount() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return pipelineLayouts_.size();
+        }
+
+    private:
+
+        struct Binding {
+            uint32_t binding;
+            VkDescriptorType type;
+            uint32_t count;
+            VkShaderStageFlags stages;
+            VkDescriptorBindingFlags flags;
+
+            bool operator==(Binding const&) const = default;
+        };
+
+        struct SetLayoutKey {
+            VkDescriptorSetLayoutCreateFlags flags;
+            std::vector<Binding> bindings;
+
+            bool operator==(SetLayoutKey const&) const = default;
+        };
+
+        struct SetLayoutKeyHash {
+            size_t operator()(SetLayoutKey const& key) const {
+                uint64_t hash = Hash::BASIS;
+                Hash::combine(hash, key.flags);
+                for (Binding const& binding : key.bindings) {
+                    Hash::combine(hash, binding.binding);
+                    Hash::combine(hash, binding.type);
+                    Hash::combine(hash, binding.count);
+                    Hash::combine(hash, binding.stages);
+                    Hash::combine(hash, binding.flags);
+                }
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        struct PushConstantRange {
+            VkShaderStageFlags stages;
+            uint32_t offset;
+            uint32_t size;
+
+            bool operator==(PushConstantRange const&) const = default;
+        };
+
+        struct PipelineLayoutKey {
+            std::vector<VkDescriptorSetLayout> setLayouts;
+            std::vector<PushConstantRange> pushConstantRanges;
+
+            bool operator==(PipelineLayoutKey const&) const = default;
+        };
+
+        struct PipelineLayoutKeyHash {
+            size_t operator()(PipelineLayoutKey const& key) const {
+                uint64_t hash = Hash::BASIS;
+                for (VkDescriptorSetLayout setLayout : key.setLayouts) Hash::combine(hash, setLayout);
+                for (PushConstantRange const& range : key.pushConstantRanges) {
+                    Hash::combine(hash, range.stages);
+                    Hash::combine(hash, range.offset);
+                    Hash::combine(hash, range.size);
+                }
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        VkDevice devicePtr_;
+
+        mutable std::mutex mutex_;
+
+        std::unordered_map<SetLayoutKey, VkDescriptorSetLayout, SetLayoutKeyHash> setLayouts_;
+        std::unordered_map<PipelineLayoutKey, VkPipelineLayout, PipelineLayoutKeyHash> pipelineLayouts_;
+
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Texture.hpp>
+#include <VulkanObjects/DescriptorAllocator.hpp>
+#include <VulkanObjects/Shader.hpp>
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+//Textures and parameters of the per material set of a shader (see Shader::addMaterialBindings).
+//Only the descriptor sets and the parameter blocks are owned: every material of a shader uses its layouts and its pipelines,
+//so the draws can be sorted by pipeline and only rebind the material set between them.
+class Material {
+
+    public:
+
+        //The shader must have generated its bindings and sets, and outlive the material
+        Material(const Device* device, DescriptorAllocator* descriptorAllocator, Shader const& shader, uint16_t nbFrames)
+            : device_(device), descriptorAllocator_(descriptorAllocator), shader_(&shader) {
+
+            setLayout_ = shader.getSetLayout(SetFrequency::PerMaterial);
+            if (!setLayout_ || shader.getMaterialBindings().empty()) {
+                throw std::runtime_error("The shader has no material bindings !");
+            }
+
+            for (MaterialBindingInformations const& bindingInformations : shader.getMaterialBindings()) {
+                if (bindingInformations.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+                    parameterBlocks_.emplace_back(nbFrames, UniformInformations{bindingInformations.binding, bindingInformations.bufferSize, bindingInformations.flags, SetFrequency::PerMaterial});
+                    parameterBlocks_.back().allocate(device_->getAllocator(), device_->getPhysical());
+                }
+            }
+
+            createDescriptorSets(nbFrames);
+        }
+
+        ~Material() {
+
+            for (UniformBufferWrapper& parameterBlock : parameterBlocks_)
+                parameterBlock.deallocate(device_->getAllocator());
+
+            if (!descriptorSets_.empty()) {
+                descriptorAllocator_->free(descriptorSets_);
+                descriptorSets_.clear();
+            }
+
+        }
+
+        Material(Material&&) = delete; //TODO: Declarer un move constructor
+        Material& operator=(Material&&) = delete;
+
+        Material(const Material&) = delete;
+        Material& operator=(const Material&) = delete;
+
+        //Every texture binding must be set before the first bind. The frames in flight must not use the material.
+        //The texture is not owned and must outlive the material
+        void setTexture(uint32_t binding, Texture const& texture) {
+
+            if (getBindingType(binding) != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+                throw std::runtime_error("Not a texture binding of the material !");
+            }
+
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = texture.getImageView();
+            imageInfo.sampler = texture.getSampler();
+
+            std::vector<VkWriteDescriptorSet> writeDescriptors(descriptorSets_.size());
+            for (size_t i = 0; i < descriptorSets_.size(); ++i) {
+                writeDescriptors[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptors[i].dstSet = descriptorSets_[i];
+                writeDescriptors[i].dstBinding = binding;
+                writeDescriptors[i].dstArrayElement = 0;
+                writeDescriptors[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                writeDescriptors[i].descriptorCount = 1;
+                writeDescriptors[i].pImageInfo = &imageInfo;
+            }
+
+            vkUpdateDescriptorSets(device_->get(), static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data(), 0, nullptr);
+
+        }
+
+        //Write the parameter block of the frame, like Shader::updateUniform
+        void updateParameters(uint32_t binding, uint32_t frameIndex, const void* data, size_t dataSize) const {
+
+            for (UniformBufferWrapper const& parameterBlock : parameterBlocks_) {
+                if (parameterBlock.informations.binding == binding) {
+                    memcpy(parameterBlock.uniformBuffersMapped[frameIndex], data, dataSize);
+                    return;
+                }
+            }
+
+            throw std::runtime_error("Not a parameter block of the material !");
+
+        }
+
+        //The pipeline bound must have a layout compatible with the one of the shader
+        inline void bind(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+            VkDescriptorSet descriptorSet = descriptorSets_[frameIndex % descriptorSets_.size()];
+            vkCmdBindDescriptorSets(commandBuffer, shader_->getBindPoint(), shader_->getPipelineLayout(), shader_->getDescriptorSetIndex(SetFrequency::PerMaterial), 1, &descriptorSet, 0, nullptr);
+        }
+
+        inline Shader const& getShader() const {
+            return *shader_;
+        }
+
+    private:
+
+        VkDescriptorType getBindingType(uint32_t binding) const {
+            for (MaterialBindingInformations const& bindingInformations : shader_->getMaterialBindings()) {
+                if (bindingInformations.binding == binding) return bindingInformations.type;
+            }
+
+            throw std::runtime_error("Unknown material binding !");
+        }
+
+        //One set per frame with parameter blocks, else one set for all the frames
+        void createDescriptorSets(uint16_t nbFrames) {
+
+            descriptorSets_.resize(parameterBlocks_.empty() ? 1 : nbFrames);
+            for (VkDescriptorSet& descriptorSet : descriptorSets_) {
+                descriptorSet = descriptorAllocator_->allocate(setLayout_);
+            }
+
+            if (parameterBlocks_.empty()) return;
+
+            for (size_t frameIndex = 0; frameIndex < descriptorSets_.size(); ++frameIndex) {
+
+                std::vector<VkDescriptorBufferInfo> buffersInfos(parameterBlocks_.size());
+                std::vector<VkWriteDescriptorSet> writeDescriptors(parameterBlocks_.size());
+
+                for (size_t i = 0; i < parameterBlocks_.size(); ++i) {
+
+                    buffersInfos[i].buffer = parameterBlocks_[i].uniformBuffers[frameIndex];
+                    buffersInfos[i].offset = 0;
+                    buffersInfos[i].range = parameterBlocks_[i].informations.bufferSize;
+
+                    writeDescriptors[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    writeDescriptors[i].dstSet = descriptorSets_[frameIndex];
+                    writeDescriptors[i].dstBinding = parameterBlocks_[i].informations.binding;
+                    writeDescriptors[i].dstArrayElement = 0;
+                    writeDescriptors[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                    writeDescriptors[i].descriptorCount = 1;
+                    writeDescriptors[i].pBufferInfo = &buffersInfos[i];
+
+                }
+
+                vkUpdateDescriptorSets(device_->get(), static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data(), 0, nullptr);
+
+            }
+
+        }
+
+        //Vulkan objects
+        const Device* device_;
+        DescriptorAllocator* descriptorAllocator_;
+        Shader const* shader_;
+
+        //Owned by the layout cache
+        VkDescriptorSetLayout setLayout_ = nullptr;
+
+        std::vector<VkDescriptorSet> descriptorSets_;
+
+        //Uniform buffers of the material, one per frame in flight
+        std::vector<UniformBufferWrapper> parameterBlocks_;
+
+};
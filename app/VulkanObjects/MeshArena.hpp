@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/UploadManager.hpp>
+#include <VulkanObjects/GpuTimeline.hpp>
+#include <VulkanObjects/Helper/Buffer.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <vector>
+#include <deque>
+#include <numeric>
+#include <stdexcept>
+
+//Vertices and indices of many meshes in one vertex buffer and one index buffer.
+//The space is suballocated with VMA virtual blocks (TLSF), counted in vertices and in indices,
+//so a mesh is only offsets: all the meshes are drawn after a single bind, with vkCmdDrawIndexed offsets.
+class MeshArena {
+
+    public:
+
+        //Part of the arena used by a mesh. The indices are relative to the first vertex of the mesh
+        struct Mesh {
+            uint32_t firstIndex = 0;
+            int32_t vertexOffset = 0;
+            uint32_t indexCount = 0;
+
+            VmaVirtualAllocation vertexAllocation = VK_NULL_HANDLE;
+            VmaVirtualAllocation indexAllocation = VK_NULL_HANDLE;
+        };
+
+        //attributesSize: number of floats of each attribute, like the graphics pipelines using the arena.
+        //frameTimeline: timeline of the frames drawing the meshes, the freed ranges are reused once they are finished
+        MeshArena(const Device* device, UploadManager* uploadManager, GpuTimeline* frameTimeline, std::vector<uint32_t> const& attributesSize, uint32_t vertexCapacity, uint32_t indexCapacity)
+            : device_(device), uploadManager_(uploadManager), frameTimeline_(frameTimeline), vertexCapacity_(vertexCapacity), indexCapacity_(indexCapacity) {
+
+            vertexStride_ = sizeof(float) * std::reduce(attributesSize.begin(), attributesSize.end());
+
+            Buffer::create(device_->getAllocator(), vertexStride_ * vertexCapacity_, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 0, vertexBuffer_, vertexBufferAllocation_, nullptr);
+            Buffer::create(device_->getAllocator(), sizeof(uint32_t) * indexCapacity_, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 0, indexBuffer_, indexBufferAllocation_, nullptr);
+
+            vertexBlock_ = createBlock(vertexCapacity_);
+            indexBlock_ = createBlock(indexCapacity_);
+        }
+
+        ~MeshArena() {
+
+            //The meshes not freed, or waiting for the GPU, are released with their block
+            if (vertexBlock_) {
+                vmaClearVirtualBlock(vertexBlock_);
+                vmaDestroyVirtualBlock(vertexBlock_);
+            }
+            if (indexBlock_) {
+                vmaClearVirtualBlock(indexBlock_);
+                vmaDestroyVirtualBlock(indexBlock_);
+            }
+
+            if (vertexBuffer_) vmaDestroyBuffer(device_->getAllocator(), vertexBuffer_, vertexBufferAllocation_);
+            if (indexBuffer_) vmaDestroyBuffer(device_->getAllocator(), indexBuffer_, indexBufferAllocation_);
+
+        }
+
+        MeshArena(MeshArena&&) = delete; //TODO: Declarer un move constructor
+        MeshArena& operator=(MeshArena&&) = delete;
+
+        MeshArena(const MeshArena&) = delete;
+        MeshArena& operator=(const MeshArena&) = delete;
+
+        //vertices: interleaved attributes, like VertexData::setData.
+        //Note: the copies are only recorded, they are submitted with the next flush of the upload manager
+        Mesh allocate(std::vector<float> const& vertices, std::vector<uint32_t> const& indices) {
+
+            if ((vertices.size() * sizeof(float)) % vertexStride_ != 0) {
+                throw std::runtime_error("The vertices don't match the attributes of the mesh arena !");
+            }
+
+            uint32_t vertexCount = static_cast<uint32_t>(vertices.size() * sizeof(float) / vertexStride_);
+            uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+            if (vertexCount == 0 || indexCount == 0) {
+                throw std::runtime_error("Empty mesh !");
+            }
+
+            collectFrees();
+
+            Mesh mesh;
+            VkDeviceSize firstVertex, firstIndex;
+
+            if (!allocateRange(vertexBlock_, vertexCount, mesh.vertexAllocation, firstVertex)) {
+                throw std::runtime_error("Mesh arena is full (vertices) !");
+            }
+
+            if (!allocateRange(indexBlock_, indexCount, mesh.indexAllocation, firstIndex)) {
+                vmaVirtualFree(vertexBlock_, mesh.vertexAllocation);
+                throw std::runtime_error("Mesh arena is full (indices) !");
+            }
+
+            mesh.vertexOffset = static_cast<int32_t>(firstVertex);
+            mesh.firstIndex = static_cast<uint32_t>(firstIndex);
+            mesh.indexCount = indexCount;
+
+            uploadManager_->uploadBuffer(vertexBuffer_, vertices.data(), vertexCount * vertexStride_, firstVertex * vertexStride_);
+            uploadManager_->uploadBuffer(indexBuffer_, indices.data(), indexCount * sizeof(uint32_t), firstIndex * sizeof(uint32_t));
+
+            meshCount_++;
+
+            return mesh;
+
+        }
+
+        //The ranges of the mesh are reused once the frames already submitted are finished, the arena keeps them until then
+        void free(Mesh const& mesh) {
+            pendingFrees_.push_back({frameTimeline_->getLastSubmittedValue(), mesh});
+            meshCount_--;
+        }
+
+        //Once for all the meshes of the arena
+        void bind(VkCommandBuffer commandBuffer) const {
+            VkBuffer vertexBuffers[] = {vertexBuffer_};
+            VkDeviceSize offsets[] = {0};
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer_, 0, VK_INDEX_TYPE_UINT32);
+        }
+
+        void draw(VkCommandBuffer commandBuffer, Mesh const& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const {
+            vkCmdDrawIndexed(commandBuffer, mesh.indexCount, instanceCount, mesh.firstIndex, mesh.vertexOffset, firstInstance);
+        }
+
+        VkBuffer getVertexBuffer() const {
+            return vertexBuffer_;
+        }
+
+        VkBuffer getIndexBuffer() const {
+            return indexBuffer_;
+        }
+
+        uint32_t getMeshCount() const {
+            return meshCount_;
+        }
+
+        //In vertices, the freed meshes waiting for the GPU included
+        VkDeviceSize getUsedVertices() const {
+            return getUsedSize(vertexBlock_);
+        }
+
+        //In indices, the freed meshes waiting for the GPU included
+        VkDeviceSize getUsedIndices() const {
+            return getUsedSize(indexBlock_);
+        }
+
+    private:
+
+        //Freed by the user, still used by the frames submitted up to value
+        struct PendingFree {
+            uint64_t value;
+            Mesh mesh;
+        };
+
+        //Give back the ranges of the freed meshes the GPU is done with
+        void collectFrees() {
+
+            if (pendingFrees_.empty()) return;
+
+            uint64_t completedValue = frameTimeline_->getCompletedValue();
+
+            while (!pendingFrees_.empty() && pendingFrees_.front().value <= completedValue) {
+                vmaVirtualFree(vertexBlock_, pendingFrees_.front().mesh.vertexAllocation);
+                vmaVirtualFree(indexBlock_, pendingFrees_.front().mesh.indexAllocation);
+                pendingFrees_.pop_front();
+            }
+
+        }
+
+        static VmaVirtualBlock createBlock(VkDeviceSize size) {
+
+            VmaVirtualBlockCreateInfo blockCreateInfo{};
+            blockCreateInfo.size = size;
+
+            VmaVirtualBlock block;
+            if (vmaCreateVirtualBlock(&blockCreateInfo, &block) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create the mesh arena block !");
+            }
+
+            return block;
+
+        }
+
+        static bool allocateRange(VmaVirtualBlock block, VkDeviceSize size, VmaVirtualAllocation& allocation, VkDeviceSize& offset) {
+
+            VmaVirtualAllocationCreateInfo allocationCreateInfo{};
+            allocationCreateInfo.size = size;
+
+            return vmaVirtualAllocate(block, &allocationCreateInfo, &allocation, &offset) == VK_SUCCESS;
+
+        }
+
+        static VkDeviceSize getUsedSize(VmaVirtualBlock block) {
+            VmaStatistics statistics;
+            vmaGetVirtualBlockStatistics(block, &statistics);
+            return statistics.allocationBytes;
+        }
+
+        //Vulkan objects save
+        const Device* device_;
+        UploadManager* uploadManager_;
+        GpuTimeline* frameTimeline_;
+
+        VkDeviceSize vertexStride_;
+        uint32_t vertexCapacity_;
+        uint32_t indexCapacity_;
+
+        VkBuffer vertexBuffer_ = nullptr;
+        VmaAllocation vertexBufferAllocation_ = nullptr;
+
+        VkBuffer indexBuffer_ = nullptr;
+        VmaAllocation indexBufferAllocation_ = nullptr;
+
+        //Suballocators, the units are vertices and indices
+        VmaVirtualBlock vertexBlock_ = VK_NULL_HANDLE;
+        VmaVirtualBlock indexBlock_ = VK_NULL_HANDLE;
+
+        uint32_t meshCount_ = 0;
+        std::deque<PendingFree> pendingFrees_;
+
+};
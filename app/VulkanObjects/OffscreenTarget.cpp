@@ -0,0 +1,30 @@
+
+#include <VulkanObjects/OffscreenTarget.hpp>
+
+
+void OffscreenTarget::initializeFramebuffers(RenderPass const& renderPass) {
+
+    framebuffers_.resize(imageViews_.size());
+
+    std::vector<VkImageView> attachments(1 + depthCheck_);
+    if (depthCheck_) attachments[1] = depthImageView_;
+
+    for (size_t i = 0; i < imageViews_.size(); i++) {
+
+        attachments[0] = imageViews_[i];
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass.get();
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        framebufferInfo.pAttachments = attachments.data();
+        framebufferInfo.width = extent_.width;
+        framebufferInfo.height = extent_.height;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(devicePtr_, &framebufferInfo, nullptr, &framebuffers_[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create framebuffer !");
+        }
+    }
+
+}
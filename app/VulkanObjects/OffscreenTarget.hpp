@@ -0,0 +1,199 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/RenderPass.hpp>
+
+#include <VulkanObjects/Helper/Image.hpp>
+#include <VulkanObjects/Helper/Getter.hpp>
+#include <VulkanObjects/Helper/Buffer.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <vector>
+#include <stdexcept>
+
+//To correct circular include
+class RenderPass;
+
+//Replace the SwapChain when rendering without window: one color image (and its readback buffer) per frame in flight
+class OffscreenTarget {
+
+    public:
+        OffscreenTarget(Device const& device, VkExtent2D const& extent, uint16_t imageCount, bool depthCheck = false, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM)
+            : devicePtr_(device.get()), allocatorPtr_(device.getAllocator()), format_(format), texelSize_(Image::getTexelSize(format)), extent_(extent), depthCheck_(depthCheck) {
+            initializeImages(imageCount);
+            initializeReadbackBuffers();
+            if (depthCheck_) initializeDepthResources(device);
+        };
+
+        ~OffscreenTarget() {
+            clean();
+        }
+
+        OffscreenTarget(OffscreenTarget&&) = delete; //TODO: Declarer un move constructor
+        OffscreenTarget& operator=(OffscreenTarget&&) = delete;
+
+        OffscreenTarget(const OffscreenTarget&) = delete;
+        OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+
+        void clean() {
+            for (size_t i = 0; i < framebuffers_.size(); i++) {
+                vkDestroyFramebuffer(devicePtr_, framebuffers_[i], nullptr);
+            }
+            framebuffers_.clear();
+
+            for (size_t i = 0; i < images_.size(); i++) {
+                vkDestroyImageView(devicePtr_, imageViews_[i], nullptr);
+                vmaDestroyImage(allocatorPtr_, images_[i], imagesAllocation_[i]);
+                vmaDestroyBuffer(allocatorPtr_, readbackBuffers_[i], readbackBuffersAllocation_[i]);
+            }
+            images_.clear();
+
+            if (depthCheck_ && depthImage_) {
+                vkDestroyImageView(devicePtr_, depthImageView_, nullptr);
+                vmaDestroyImage(allocatorPtr_, depthImage_, depthImageAllocation_);
+                depthImage_ = nullptr;
+            }
+        }
+
+        void initializeImages(uint16_t imageCount) {
+
+            images_.resize(imageCount);
+            imagesAllocation_.resize(imageCount);
+            imageViews_.resize(imageCount);
+
+            for (size_t i = 0; i < imageCount; i++) {
+                //Transfer source to be able to copy the result back to the CPU
+                Buffer::createImage(allocatorPtr_, extent_.width, extent_.height, format_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, images_[i], imagesAllocation_[i]);
+                imageViews_[i] = Image::createImageView(devicePtr_, images_[i], format_, VK_IMAGE_ASPECT_COLOR_BIT);
+            }
+
+        }
+
+        void initializeReadbackBuffers() {
+
+            readbackBuffers_.resize(images_.size());
+            readbackBuffersAllocation_.resize(images_.size());
+            readbackBuffersMapped_.resize(images_.size());
+
+            for (size_t i = 0; i < images_.size(); i++) {
+                VmaAllocationInfo allocationInfo;
+                //Random access since the CPU will read it
+                Buffer::create(allocatorPtr_, getReadbackSize(), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, readbackBuffers_[i], readbackBuffersAllocation_[i], &allocationInfo);
+
+                readbackBuffersMapped_[i] = allocationInfo.pMappedData;
+            }
+
+        }
+
+        void initializeDepthResources(Device const& device) {
+
+            depthFormat_ = Getter::findDepthFormat(device.getPhysical());
+
+            Buffer::createImage(device.getAllocator(), extent_.width, extent_.height, depthFormat_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, depthImage_, depthImageAllocation_);
+
+            depthImageView_ = Image::createImageView(devicePtr_, depthImage_, depthFormat_, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+        }
+
+        //Note: Must be initialized after the RenderPass, but RenderPass require OffscreenTarget to be initialized
+        void initializeFramebuffers(RenderPass const& renderPass);
+
+        //Record the copy of the color image into its readback buffer, the render pass must have ended (image in transfer source layout)
+        void recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex) const {
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = 0;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {extent_.width, extent_.height, 1};
+
+            vkCmdCopyImageToBuffer(commandBuffer, images_[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffers_[imageIndex], 1, &region);
+
+            //Make the transfer visible to the host once the submission fence is signaled
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        }
+
+        //Only valid once the submission that recorded the readback is finished
+        void const* getReadbackData(uint32_t imageIndex) const {
+            //Does nothing if the memory is host coherent
+            vmaInvalidateAllocation(allocatorPtr_, readbackBuffersAllocation_[imageIndex], 0, VK_WHOLE_SIZE);
+            return readbackBuffersMapped_[imageIndex];
+        }
+
+        //Tightly packed, getTexelSize bytes per pixel
+        VkDeviceSize getReadbackSize() const {
+            return static_cast<VkDeviceSize>(extent_.width) * extent_.height * texelSize_;
+        }
+
+        uint32_t getTexelSize() const {
+            return texelSize_;
+        }
+
+        //Depth related
+        VkFormat getDepthFormat() const {
+            return depthFormat_;
+        }
+
+        //Framebuffers
+        std::vector<VkFramebuffer> const& getFramebuffers() const {
+            return framebuffers_;
+        }
+
+        //Format and extent
+        VkFormat getFormat() const {
+            return format_;
+        }
+
+        VkExtent2D const& getExtent() const {
+            return extent_;
+        }
+
+    private:
+
+        //Save
+        VkDevice devicePtr_;
+        VmaAllocator allocatorPtr_;
+
+        //Color images, one per frame in flight
+        std::vector<VkImage> images_;
+        std::vector<VmaAllocation> imagesAllocation_;
+        std::vector<VkImageView> imageViews_;
+        std::vector<VkFramebuffer> framebuffers_;
+
+        //Host visible copies of the color images
+        std::vector<VkBuffer> readbackBuffers_;
+        std::vector<VmaAllocation> readbackBuffersAllocation_;
+        std::vector<void*> readbackBuffersMapped_;
+
+        //Store the formant and the extent
+        VkFormat format_;
+        uint32_t texelSize_;
+        VkExtent2D extent_;
+
+        //Depth and stencil
+        VkFormat depthFormat_ = VK_FORMAT_UNDEFINED;
+        VkImage depthImage_ = nullptr;
+        VmaAllocation depthImageAllocation_;
+        VkImageView depthImageView_;
+
+        //Variable
+        bool depthCheck_;
+
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/CommandPool.hpp>
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+//Secondary command buffers recorded by several threads: each worker has its own command pool per frame in flight,
+//so the workers never share a pool and need no lock.
+class ParallelRecorder {
+
+    public:
+        ParallelRecorder(Device const& device, uint16_t framesInFlight) : devicePtr_(&device), framesInFlight_(framesInFlight) {};
+
+        ParallelRecorder(ParallelRecorder&&) = delete; //TODO: Declarer un move constructor
+        ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+        ParallelRecorder(const ParallelRecorder&) = delete;
+        ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+        //The previous submission of the frame must be finished and no worker must be recording
+        void beginFrame(uint32_t frameIndex, uint32_t workerCount) {
+
+            currentFrame_ = frameIndex;
+
+            //Only grow, the pools of the other frames may still be in use
+            while (workers_.size() < workerCount) {
+                addWorker();
+            }
+
+            //Reset the whole pool at once, cheaper than resetting each command buffer
+            for (std::vector<WorkerFrame>& worker : workers_) {
+                WorkerFrame& workerFrame = worker[currentFrame_];
+
+                if (workerFrame.usedCount > 0) {
+                    vkResetCommandPool(devicePtr_->get(), workerFrame.commandPool->get(), 0);
+                    workerFrame.usedCount = 0;
+                }
+            }
+
+        }
+
+        //Can be called concurrently by different workers, the inheritance must describe the render pass being recorded
+        VkCommandBuffer begin(uint32_t workerIndex, VkCommandBufferInheritanceInfo const& inheritanceInfo) {
+
+            if (workerIndex >= workers_.size()) {
+                throw std::runtime_error("Worker index out of the parallel recording range !");
+            }
+
+            WorkerFrame& workerFrame = workers_[workerIndex][currentFrame_];
+
+            if (workerFrame.usedCount == workerFrame.commandBuffers.size()) {
+                allocateCommandBuffer(workerFrame);
+            }
+
+            VkCommandBuffer commandBuffer = workerFrame.commandBuffers[workerFrame.usedCount++];
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin recording secondary command buffer !");
+            }
+
+            return commandBuffer;
+
+        }
+
+        void end(VkCommandBuffer commandBuffer) {
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record secondary command buffer !");
+            }
+        }
+
+        //Once all workers ended their command buffers: execute them in the worker order, inside the render pass of the primary
+        void recordExecute(VkCommandBuffer primaryCommandBuffer) {
+
+            executed_.clear();
+
+            for (std::vector<WorkerFrame>& worker : workers_) {
+                WorkerFrame& workerFrame = worker[currentFrame_];
+                executed_.insert(executed_.end(), workerFrame.commandBuffers.begin(), workerFrame.commandBuffers.begin() + workerFrame.usedCount);
+            }
+
+            if (!executed_.empty()) {
+                vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(executed_.size()), executed_.data());
+            }
+
+        }
+
+        uint32_t getWorkerCount() const {
+            return static_cast<uint32_t>(workers_.size());
+        }
+
+    private:
+
+        struct WorkerFrame {
+            std::unique_ptr<CommandPool> commandPool;
+            std::vector<VkCommandBuffer> commandBuffers;
+            size_t usedCount = 0;
+        };
+
+        void addWorker() {
+
+            std::vector<WorkerFrame>& worker = workers_.emplace_back(framesInFlight_);
+
+            //Transient: the command buffers are rerecorded every frame
+            for (WorkerFrame& workerFrame : worker) {
+                workerFrame.commandPool = std::make_unique<CommandPool>(*devicePtr_, devicePtr_->getQueueFamilyIndices().graphicsFamily.value(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+            }
+
+        }
+
+        void allocateCommandBuffer(WorkerFrame& workerFrame) {
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = workerFrame.commandPool->get();
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer;
+            if (vkAllocateCommandBuffers(devicePtr_->get(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate secondary command buffer !");
+            }
+
+            workerFrame.commandBuffers.push_back(commandBuffer);
+
+        }
+
+        const Device* devicePtr_;
+        uint16_t framesInFlight_;
+
+        uint32_t currentFrame_ = 0;
+
+        //By worker, then by frame in flight
+        std::vector<std::vector<WorkerFrame>> workers_;
+
+        //Avoid reallocation every frame
+        std::vector<VkCommandBuffer> executed_;
+
+};
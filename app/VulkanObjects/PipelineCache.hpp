@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+//VkPipelineCache persisted in a file, so the driver doesn't compile again the pipelines of the previous launches.
+//Shared by all the pipelines of the device: the cache is internally synchronized, it can be used from several threads.
+class PipelineCache {
+
+    public:
+        PipelineCache() {};
+
+        ~PipelineCache() {
+            clean();
+        }
+
+        PipelineCache(PipelineCache&&) = delete; //TODO: Declarer un move constructor
+        PipelineCache& operator=(PipelineCache&&) = delete;
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        //Load the file if it was written by the same driver and device, start empty otherwise
+        void initialize(VkDevice device, VkPhysicalDevice physicalDevice, std::string const& filename) {
+
+            devicePtr_ = device;
+            filename_ = filename;
+
+            std::vector<char> data = readFile(filename_);
+            if (!isCompatible(physicalDevice, data)) data.clear();
+
+            VkPipelineCacheCreateInfo cacheInfo{};
+            cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            cacheInfo.initialDataSize = data.size();
+            cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+            if (vkCreatePipelineCache(devicePtr_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline cache !");
+            }
+
+        }
+
+        //Write the cache in the file. Failing to save only make the next launch slower, so errors are ignored
+        void save() const {
+
+            if (!pipelineCache_) return;
+
+            size_t size = 0;
+            if (vkGetPipelineCacheData(devicePtr_, pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0) return;
+
+            std::vector<char> data(size);
+            if (vkGetPipelineCacheData(devicePtr_, pipelineCache_, &size, data.data()) != VK_SUCCESS) return;
+
+            //Write a temporary file first, a crash while writing must not leave a truncated cache
+            std::string temporaryFilename = filename_ + ".tmp";
+            {
+                std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) return;
+
+                file.write(data.data(), static_cast<std::streamsize>(size));
+                if (!file.good()) return;
+            }
+
+            std::remove(filename_.c_str());
+            std::rename(temporaryFilename.c_str(), filename_.c_str());
+
+        }
+
+        void clean() {
+            if (pipelineCache_) {
+                vkDestroyPipelineCache(devicePtr_, pipelineCache_, nullptr);
+                pipelineCache_ = VK_NULL_HANDLE;
+            }
+        }
+
+        VkPipelineCache get() const {
+            return pipelineCache_;
+        }
+
+    private:
+
+        //Missing file give an empty cache
+        static std::vector<char> readFile(std::string const& filename) {
+
+            std::ifstream file(filename, std::ios::ate | std::ios::binary);
+            if (!file.is_open()) return {};
+
+            std::vector<char> data(static_cast<size_t>(file.tellg()));
+
+            file.seekg(0);
+            file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+            if (!file.good()) return {};
+            return data;
+
+        }
+
+        //Header (version one): header size, header version, vendor ID, device ID then the pipeline cache UUID
+        static bool isCompatible(VkPhysicalDevice physicalDevice, std::vector<char> const& data) {
+
+            constexpr size_t HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+            if (data.size() < HEADER_SIZE) return false;
+
+            uint32_t header[4];
+            memcpy(header, data.data(), sizeof(header));
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+            return header[0] >= HEADER_SIZE && header[0] <= data.size()
+                && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && header[2] == properties.vendorID
+                && header[3] == properties.deviceID
+                && memcmp(data.data() + 4 * sizeof(uint32_t), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+        }
+
+        VkDevice devicePtr_ = VK_NULL_HANDLE;
+        std::string filename_;
+
+        VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
+
+};
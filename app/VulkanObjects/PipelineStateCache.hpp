@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/PipelineStateKey.hpp>
+
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <stdexcept>
+
+//The VkPipelines shared by the GraphicsPipelines with the same state, reference counted.
+//Thread safe, the pipelines can be built from several threads.
+class PipelineStateCache {
+
+    public:
+
+        struct Statistics {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            size_t pipelineCount = 0;
+        };
+
+        PipelineStateCache(Device const& device) : devicePtr_(device.get()) {};
+
+        //Note: the frames using the pipelines must be finished
+        ~PipelineStateCache() {
+            for (auto& [key, entry] : entries_) {
+                vkDestroyPipeline(devicePtr_, entry.pipeline, nullptr);
+            }
+        }
+
+        PipelineStateCache(PipelineStateCache&&) = delete; //TODO: Declarer un move constructor
+        PipelineStateCache& operator=(PipelineStateCache&&) = delete;
+
+        PipelineStateCache(const PipelineStateCache&) = delete;
+        PipelineStateCache& operator=(const PipelineStateCache&) = delete;
+
+        //Return the pipeline of this state, created with createPipeline if there is none. Each acquire must be matched by a release
+        VkPipeline acquire(PipelineStateKey const& key, std::function<VkPipeline()> const& createPipeline) {
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                auto found = entries_.find(key);
+                if (found != entries_.end()) {
+                    ++found->second.references;
+                    ++statistics_.hits;
+                    return found->second.pipeline;
+                }
+
+                ++statistics_.misses;
+            }
+
+            //Created without the lock, so the other states are still built in parallel
+            VkPipeline pipeline = createPipeline();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto [entry, inserted] = entries_.try_emplace(key, Entry{pipeline, 0});
+
+            //Another thread created the same state meanwhile
+            if (!inserted) vkDestroyPipeline(devicePtr_, pipeline, nullptr);
+
+            ++entry->second.references;
+            return entry->second.pipeline;
+
+        }
+
+        //Return the pipeline if it is not used anymore, the caller destroys it once the frames using it are finished
+        VkPipeline release(PipelineStateKey const& key) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto found = entries_.find(key);
+            if (found == entries_.end()) {
+                throw std::runtime_error("Releasing a pipeline state not acquired !");
+            }
+
+            if (--found->second.references > 0) return VK_NULL_HANDLE;
+
+            VkPipeline pipeline = found->second.pipeline;
+            entries_.erase(found);
+            return pipeline;
+        }
+
+        //A high miss count compared to the pipeline count means redundant creations
+        Statistics getStatistics() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            Statistics statistics = statistics_;
+            statistics.pipelineCount = entries_.size();
+            return statistics;
+        }
+
+        void resetStatistics() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            statistics_ = {};
+        }
+
+    private:
+
+        struct Entry {
+            VkPipeline pipeline;
+            uint32_t references;
+        };
+
+        VkDevice devicePtr_;
+
+        mutable std::mutex mutex_;
+
+        std::unordered_map<PipelineStateKey, Entry, PipelineStateKeyHash> entries_;
+        Statistics statistics_;
+
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/SpecializationConstants.hpp>
+
+#include <VulkanObjects/Helper/Hash.hpp>
+
+#include <vector>
+#include <cstdint>
+
+//Fixed function states of a graphics pipeline, the defaults are the ones used by the engine
+struct PipelineFixedState {
+
+    //Input assembly
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    //Rasterizer
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    //Depth, the render pass must have a depth attachment to enable it
+    bool depthTest = false;
+    bool depthWrite = false;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+    //Color blending of the color attachment
+    bool blendEnable = false;
+    VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+    VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    bool operator==(PipelineFixedState const&) const = default;
+
+};
+
+//Everything a VkPipeline depends on: two pipelines with equal keys are interchangeable
+struct PipelineStateKey {
+
+    VkShaderModule vertexModule = VK_NULL_HANDLE;
+    VkShaderModule fragmentModule = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+
+    std::vector<uint32_t> vertexAttributesSize;
+
+    PipelineFixedState fixedState;
+
+    //Each set of values is its own variant
+    PipelineSpecialization specialization;
+
+    //Render pass compatibility: the pipeline can be used with any render pass having the same attachments
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    bool operator==(PipelineStateKey const&) const = default;
+
+    //Field per field, the padding of the structures must not be hashed
+    uint64_t hash() const {
+        uint64_t hash = Hash::BASIS;
+
+        Hash::combine(hash, vertexModule);
+        Hash::combine(hash, fragmentModule);
+        Hash::combine(hash, layout);
+
+        Hash::combine(hash, vertexAttributesSize.size());
+        for (uint32_t size : vertexAttributesSize) Hash::combine(hash, size);
+
+        Hash::combine(hash, fixedState.topology);
+        Hash::combine(hash, fixedState.polygonMode);
+        Hash::combine(hash, fixedState.cullMode);
+        Hash::combine(hash, fixedState.frontFace);
+        Hash::combine(hash, fixedState.depthTest);
+        Hash::combine(hash, fixedState.depthWrite);
+        Hash::combine(hash, fixedState.depthCompareOp);
+        Hash::combine(hash, fixedState.blendEnable);
+        Hash::combine(hash, fixedState.srcColorBlendFactor);
+        Hash::combine(hash, fixedState.dstColorBlendFactor);
+        Hash::combine(hash, fixedState.colorBlendOp);
+        Hash::combine(hash, fixedState.srcAlphaBlendFactor);
+        Hash::combine(hash, fixedState.dstAlphaBlendFactor);
+        Hash::combine(hash, fixedState.alphaBlendOp);
+        Hash::combine(hash, fixedState.colorWriteMask);
+
+        specialization.vertex.hash(hash);
+        specialization.fragment.hash(hash);
+
+        Hash::combine(hash, colorFormat);
+        Hash::combine(hash, depthFormat);
+
+        return hash;
+    }
+
+};
+
+struct PipelineStateKeyHash {
+    size_t operator()(PipelineStateKey const& key) const {
+        return static_cast<size_t>(key.hash());
+    }
+};
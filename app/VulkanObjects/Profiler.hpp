@@ -0,0 +1,414 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <chrono>
+#include <ostream>
+#include <iomanip>
+#include <stdexcept>
+
+//Time the CPU phases of the frame loop, and the GPU with timestamp queries (the render pass and user defined scopes).
+//The finished frames are published in a lock-free ring that can be read from any thread, the frame loop never waits the readers.
+//The scopes can be recorded by the parallel recording workers, each worker keeps its own list merged when the frame ends.
+class Profiler {
+
+    public:
+
+        enum CpuPhase : uint32_t {
+            FenceWait = 0,
+            Acquire,
+            Recording,
+            Submit,
+            Present,
+            CPU_PHASE_COUNT
+        };
+
+        static constexpr uint32_t MAX_SCOPES = 32;
+        static constexpr size_t RING_SIZE = 256;
+
+        //Worker index of the scopes recorded by the frame loop thread
+        static constexpr uint32_t FRAME_THREAD = UINT32_MAX;
+
+        struct ScopeRecord {
+            const char* name; //Must outlive the profiler (string literal)
+            double duration;  //ms
+        };
+
+        //All durations are in milliseconds, negative if not measured
+        struct FrameRecord {
+            uint64_t frameNumber = 0;
+            std::array<double, CPU_PHASE_COUNT> cpuPhases{};
+            double gpuRenderPass = -1.0;
+            uint32_t scopeCount = 0;
+            std::array<ScopeRecord, MAX_SCOPES> scopes{};
+        };
+
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        Profiler(Device const& device, uint16_t framesInFlight) : devicePtr_(device.get()), frames_(framesInFlight) {
+
+            //Timestamps are only supported if the graphics queue have valid bits
+            std::vector<VkQueueFamilyProperties> queueFamilies = QueueFamily::getQueueFamilies(device.getPhysical());
+            uint32_t validBits = queueFamilies[device.getQueueFamilyIndices().graphicsFamily.value()].timestampValidBits;
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device.getPhysical(), &properties);
+
+            timestampPeriod_ = properties.limits.timestampPeriod;
+            timestampMask_ = validBits >= 64 ? UINT64_MAX : ((uint64_t(1) << validBits) - 1);
+            gpuTimingSupported_ = validBits > 0;
+
+            if (gpuTimingSupported_) initializeQueryPools();
+        }
+
+        ~Profiler() {
+            for (FrameSlot& frame : frames_) {
+                if (frame.queryPool) vkDestroyQueryPool(devicePtr_, frame.queryPool, nullptr);
+            }
+        }
+
+        Profiler(Profiler&&) = delete; //TODO: Declarer un move constructor
+        Profiler& operator=(Profiler&&) = delete;
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        static TimePoint now() {
+            return std::chrono::steady_clock::now();
+        }
+
+        void setEnabled(bool enabled) {
+            enabled_ = enabled;
+        }
+
+        bool isEnabled() const {
+            return enabled_;
+        }
+
+        //// Called by the frame loop
+
+        //The previous submission of the frame must be finished: publish the previous frame of this slot, then start a new one
+        void beginFrame(uint32_t frameIndex) {
+
+            FrameSlot& frame = frames_[frameIndex];
+
+            if (frame.submitted) {
+                if (frame.gpuRecorded) readGpuResults(frame);
+                publish(frame.record);
+            }
+
+            frame.record = FrameRecord{};
+            frame.record.frameNumber = frameCounter_++;
+            frame.record.cpuPhases.fill(-1.0);
+            frame.submitted = false;
+            frame.gpuRecorded = false;
+            frame.nextScope.store(0, std::memory_order_relaxed);
+
+            for (WorkerScopes& workerScopes : frame.workerScopes) {
+                workerScopes.scopes.clear();
+                workerScopes.openScopes.clear();
+            }
+
+        }
+
+        //Before the workers start recording the frame: they use the indices 0 to workerCount - 1
+        void beginWorkers(uint32_t frameIndex, uint32_t workerCount) {
+
+            FrameSlot& frame = frames_[frameIndex];
+
+            //The first list is the one of the frame loop thread
+            if (frame.workerScopes.size() < workerCount + 1) {
+                frame.workerScopes.resize(workerCount + 1);
+            }
+
+        }
+
+        void endCpuPhase(uint32_t frameIndex, CpuPhase phase, TimePoint start) {
+            if (!enabled_) return;
+            frames_[frameIndex].record.cpuPhases[phase] = std::chrono::duration<double, std::milli>(now() - start).count();
+        }
+
+        //The work of the frame is submitted and the workers are done, its results will be published by the next beginFrame of the slot
+        void endFrame(uint32_t frameIndex) {
+
+            FrameSlot& frame = frames_[frameIndex];
+
+            //Merge the scopes of the workers, in worker order
+            frame.record.scopeCount = 0;
+            for (WorkerScopes const& workerScopes : frame.workerScopes) {
+                for (PendingScope const& scope : workerScopes.scopes) {
+                    frame.scopeQueries[frame.record.scopeCount] = scope.scopeIndex;
+                    frame.record.scopes[frame.record.scopeCount++] = {scope.name, -1.0};
+                }
+            }
+
+            frame.submitted = true;
+
+        }
+
+        //Outside of a render pass, before any other timestamp of the frame
+        void recordFrameStart(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+            if (!enabled_ || !gpuTimingSupported_) return;
+
+            FrameSlot& frame = frames_[frameIndex];
+
+            vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, QUERY_COUNT);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, 0);
+
+            frame.gpuRecorded = true;
+
+        }
+
+        void recordFrameEnd(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+            FrameSlot& frame = frames_[frameIndex];
+            if (!frame.gpuRecorded) return;
+
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, 1);
+
+        }
+
+        //// User scopes, can be nested. name must outlive the profiler.
+        //A worker only touches its own list, the queries are shared with an atomic counter
+
+        void beginScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, const char* name, uint32_t workerIndex = FRAME_THREAD) {
+
+            FrameSlot& frame = frames_[frameIndex];
+            WorkerScopes& workerScopes = getWorkerScopes(frame, workerIndex);
+
+            uint32_t scopeIndex = frame.gpuRecorded ? frame.nextScope.fetch_add(1, std::memory_order_relaxed) : MAX_SCOPES;
+
+            //Scopes are ignored when there is no more query available
+            if (scopeIndex >= MAX_SCOPES) {
+                workerScopes.openScopes.push_back(UINT32_MAX);
+                return;
+            }
+
+            workerScopes.scopes.push_back({name, scopeIndex});
+            workerScopes.openScopes.push_back(scopeIndex);
+
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, FIRST_SCOPE_QUERY + 2 * scopeIndex);
+
+        }
+
+        void endScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t workerIndex = FRAME_THREAD) {
+
+            FrameSlot& frame = frames_[frameIndex];
+            WorkerScopes& workerScopes = getWorkerScopes(frame, workerIndex);
+
+            if (workerScopes.openScopes.empty()) {
+                throw std::runtime_error("Profiler scope ended without being started !");
+            }
+
+            uint32_t scopeIndex = workerScopes.openScopes.back();
+            workerScopes.openScopes.pop_back();
+
+            if (scopeIndex == UINT32_MAX) return;
+
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, FIRST_SCOPE_QUERY + 2 * scopeIndex + 1);
+
+        }
+
+        //// Read the results, from any thread
+
+        //Number of frames published since the start
+        uint64_t getPublishedCount() const {
+            return publishedCount_.load(std::memory_order_acquire);
+        }
+
+        //Copy the published frame, false if it is not published yet or already overwritten (also while being overwritten)
+        bool getFrame(uint64_t publishedIndex, FrameRecord& record) const {
+
+            if (publishedIndex >= publishedCount_.load(std::memory_order_acquire)) return false;
+
+            RingSlot const& slot = ring_[publishedIndex % RING_SIZE];
+
+            //The slot is written once per turn of the ring, its sequence is even once the write of publishedIndex is done
+            uint64_t expectedSequence = 2 * (publishedIndex / RING_SIZE + 1);
+
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != expectedSequence) return false;
+
+            std::array<uint64_t, RECORD_WORDS> words;
+            for (size_t word = 0; word < RECORD_WORDS; ++word) {
+                words[word] = slot.words[word].load(std::memory_order_relaxed);
+            }
+
+            //The copy is only valid if the writer did not start a new write of the slot meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) return false;
+
+            memcpy(static_cast<void*>(&record), words.data(), sizeof(FrameRecord));
+            return true;
+
+        }
+
+        //Print the last count published frames
+        void dump(std::ostream& stream, size_t count = 1) const {
+
+            static const char* phaseNames[CPU_PHASE_COUNT] = {"fence wait", "acquire", "recording", "submit", "present"};
+
+            uint64_t publishedCount = getPublishedCount();
+            uint64_t first = publishedCount > count ? publishedCount - count : 0;
+
+            FrameRecord record;
+            for (uint64_t i = first; i < publishedCount; ++i) {
+
+                if (!getFrame(i, record)) continue;
+
+                stream << std::fixed << std::setprecision(3) << "Frame " << record.frameNumber << " | CPU (ms):";
+                for (uint32_t phase = 0; phase < CPU_PHASE_COUNT; ++phase) {
+                    if (record.cpuPhases[phase] >= 0.0) stream << " " << phaseNames[phase] << " " << record.cpuPhases[phase];
+                }
+
+                if (record.gpuRenderPass >= 0.0) {
+                    stream << " | GPU (ms): render pass " << record.gpuRenderPass;
+                    for (uint32_t scope = 0; scope < record.scopeCount; ++scope) {
+                        if (record.scopes[scope].duration >= 0.0) stream << ", " << record.scopes[scope].name << " " << record.scopes[scope].duration;
+                    }
+                }
+
+                stream << '\n';
+            }
+
+        }
+
+    private:
+
+        //Timestamps 0 and 1 are the frame start and end, then two per scope
+        static constexpr uint32_t FIRST_SCOPE_QUERY = 2;
+        static constexpr uint32_t QUERY_COUNT = FIRST_SCOPE_QUERY + 2 * MAX_SCOPES;
+
+        //The records are copied word by word through atomics, so a reader racing the writer is defined
+        static_assert(std::is_trivially_copyable_v<FrameRecord>, "FrameRecord must be trivially copyable");
+        static constexpr size_t RECORD_WORDS = (sizeof(FrameRecord) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct RingSlot {
+            std::atomic<uint64_t> sequence{0};
+            std::array<std::atomic<uint64_t>, RECORD_WORDS> words{};
+        };
+
+        struct PendingScope {
+            const char* name;
+            uint32_t scopeIndex;
+        };
+
+        //Scopes recorded by one thread during the frame
+        struct WorkerScopes {
+            std::vector<PendingScope> scopes;
+            std::vector<uint32_t> openScopes;
+        };
+
+        struct FrameSlot {
+            VkQueryPool queryPool = VK_NULL_HANDLE;
+            bool gpuRecorded = false;
+            bool submitted = false;
+
+            //Next free scope query, taken by any worker
+            std::atomic<uint32_t> nextScope{0};
+
+            //The frame loop thread then the workers
+            std::vector<WorkerScopes> workerScopes = std::vector<WorkerScopes>(1);
+
+            //Merged by endFrame: the record scopes and their query index
+            FrameRecord record;
+            std::array<uint32_t, MAX_SCOPES> scopeQueries{};
+        };
+
+        WorkerScopes& getWorkerScopes(FrameSlot& frame, uint32_t workerIndex) {
+
+            uint32_t listIndex = workerIndex == FRAME_THREAD ? 0 : workerIndex + 1;
+            if (listIndex >= frame.workerScopes.size()) {
+                throw std::runtime_error("Profiler worker index out of the parallel recording range !");
+            }
+
+            return frame.workerScopes[listIndex];
+
+        }
+
+        void initializeQueryPools() {
+
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = QUERY_COUNT;
+
+            for (FrameSlot& frame : frames_) {
+                if (vkCreateQueryPool(devicePtr_, &queryPoolInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create timestamp query pool !");
+                }
+            }
+
+        }
+
+        void readGpuResults(FrameSlot& frame) {
+
+            std::array<uint64_t, QUERY_COUNT> timestamps;
+            uint32_t usedQueries = FIRST_SCOPE_QUERY + 2 * std::min(frame.nextScope.load(std::memory_order_relaxed), MAX_SCOPES);
+
+            //No wait, the previous submission of the frame is finished
+            if (vkGetQueryPoolResults(devicePtr_, frame.queryPool, 0, usedQueries, usedQueries * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+                return;
+            }
+
+            frame.record.gpuRenderPass = toMilliseconds(timestamps[0], timestamps[1]);
+
+            for (uint32_t scope = 0; scope < frame.record.scopeCount; ++scope) {
+                uint32_t query = FIRST_SCOPE_QUERY + 2 * frame.scopeQueries[scope];
+                frame.record.scopes[scope].duration = toMilliseconds(timestamps[query], timestamps[query + 1]);
+            }
+
+        }
+
+        double toMilliseconds(uint64_t begin, uint64_t end) const {
+            //timestampPeriod is the number of nanoseconds per tick
+            return static_cast<double>((end - begin) & timestampMask_) * timestampPeriod_ / 1e6;
+        }
+
+        //Single writer (the frame loop thread): the sequence of the slot is odd during the copy
+        void publish(FrameRecord const& record) {
+
+            uint64_t publishedCount = publishedCount_.load(std::memory_order_relaxed);
+            RingSlot& slot = ring_[publishedCount % RING_SIZE];
+
+            std::array<uint64_t, RECORD_WORDS> words{};
+            memcpy(words.data(), &record, sizeof(FrameRecord));
+
+            uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (size_t word = 0; word < RECORD_WORDS; ++word) {
+                slot.words[word].store(words[word], std::memory_order_relaxed);
+            }
+
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+            publishedCount_.store(publishedCount + 1, std::memory_order_release);
+
+        }
+
+        VkDevice devicePtr_;
+
+        bool enabled_ = true;
+        bool gpuTimingSupported_ = false;
+        float timestampPeriod_;
+        uint64_t timestampMask_;
+
+        //By frame in flight
+        std::vector<FrameSlot> frames_;
+        uint64_t frameCounter_ = 0;
+
+        //Published frames
+        std::array<RingSlot, RING_SIZE> ring_;
+        std::atomic<uint64_t> publishedCount_{0};
+
+};
@@ -3,12 +3,20 @@
 
 
 void RenderPass::initializeRenderPass(SwapChain const& swapChain, bool depthCheck) {
+    initializeRenderPass(swapChain.getFormat(), swapChain.getDepthFormat(), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, depthCheck);
+}
+
+void RenderPass::initializeRenderPass(OffscreenTarget const& offscreenTarget, bool depthCheck) {
+    initializeRenderPass(offscreenTarget.getFormat(), offscreenTarget.getDepthFormat(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, depthCheck);
+}
+
+void RenderPass::initializeRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalLayout, bool depthCheck) {
 
 
     std::vector<VkAttachmentDescription> attachments(1 + depthCheck);
     
     // Color attachment description
-    attachments[0].format = swapChain.getFormat();
+    attachments[0].format = colorFormat;
     attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
 
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -18,7 +26,7 @@ void RenderPass::initializeRenderPass(SwapChain const& swapChain, bool depthChec
     attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    attachments[0].finalLayout = finalLayout;
 
     // Subpasses
     VkAttachmentReference colorAttachmentRef{};
@@ -34,7 +42,7 @@ void RenderPass::initializeRenderPass(SwapChain const& swapChain, bool depthChec
     VkAttachmentReference depthAttachmentRef{};
     if (depthCheck) {
         // Depth attachment description
-        attachments[1].format = swapChain.getDepthFormat();
+        attachments[1].format = depthFormat;
         attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
 
         attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -64,6 +72,23 @@ void RenderPass::initializeRenderPass(SwapChain const& swapChain, bool depthChec
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    std::vector<VkSubpassDependency> dependencies = {dependency};
+
+    // When the color attachment is read back, the copy must wait for the color writes to be done
+    if (finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+        VkSubpassDependency readbackDependency{};
+        readbackDependency.srcSubpass = 0;
+        readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+
+        readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        dependencies.push_back(readbackDependency);
+    }
+
     // The render pass
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -71,12 +96,15 @@ void RenderPass::initializeRenderPass(SwapChain const& swapChain, bool depthChec
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
 
 
     if (vkCreateRenderPass(devicePtr_, &renderPassInfo, nullptr, &renderPass_) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create render pass !");
     }
 
+    colorFormat_ = colorFormat;
+    depthFormat_ = depthCheck ? depthFormat : VK_FORMAT_UNDEFINED;
+
 }
@@ -5,11 +5,13 @@
 
 #include <VulkanObjects/Device.hpp>
 #include <VulkanObjects/SwapChain.hpp>
+#include <VulkanObjects/OffscreenTarget.hpp>
 
 #include <stdexcept>
 
 //To correct circular include
 class SwapChain;
+class OffscreenTarget;
 
 class RenderPass {
 
@@ -18,6 +20,10 @@ class RenderPass {
             initializeRenderPass(swapChain, depthCheck);
         };
 
+        RenderPass(Device const& device, OffscreenTarget const& offscreenTarget, bool depthCheck = false) : devicePtr_(device.get()) {
+            initializeRenderPass(offscreenTarget, depthCheck);
+        };
+
         ~RenderPass() {
             clean();
         }
@@ -33,16 +39,40 @@ class RenderPass {
         RenderPass& operator=(const RenderPass&) = delete;
 
         void initializeRenderPass(SwapChain const& swapChain, bool depthCheck);
+        void initializeRenderPass(OffscreenTarget const& offscreenTarget, bool depthCheck);
+
+        //finalLayout is the layout of the color attachment after the render pass (present or transfer source for readback)
+        void initializeRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalLayout, bool depthCheck);
 
         VkRenderPass get() const {
             return renderPass_;
         }
+
+        //Give up the ownership of the render pass, to destroy it later
+        VkRenderPass release() {
+            VkRenderPass renderPass = renderPass_;
+            renderPass_ = VK_NULL_HANDLE;
+            return renderPass;
+        }
+
+        //The attachments decide which pipelines are compatible with the render pass
+        VkFormat getColorFormat() const {
+            return colorFormat_;
+        }
+
+        //VK_FORMAT_UNDEFINED without depth attachment
+        VkFormat getDepthFormat() const {
+            return depthFormat_;
+        }
         
 
     private:
         VkDevice devicePtr_;
 
-        VkRenderPass renderPass_;
+        VkRenderPass renderPass_ = VK_NULL_HANDLE;
+
+        VkFormat colorFormat_ = VK_FORMAT_UNDEFINED;
+        VkFormat depthFormat_ = VK_FORMAT_UNDEFINED;
 
 
 };
@@ -6,17 +6,75 @@
 #include <VulkanObjects/Device.hpp>
 #include <VulkanObjects/Allocator.hpp>
 #include <VulkanObjects/Texture.hpp>
+#include <VulkanObjects/SpecializationConstants.hpp>
+#include <VulkanObjects/UniformRing.hpp>
+#include <VulkanObjects/DescriptorAllocator.hpp>
+#include <VulkanObjects/LayoutCache.hpp>
+#include <VulkanObjects/BindlessTextures.hpp>
 
 #include <VulkanObjects/Helper/Buffer.hpp>
 
 #include <optional>
 #include <vector>
 #include <array>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
+
+//Descriptor sets of a shader, from the least to the most often rebound.
+//Binding a set keeps the sets before it bound, so a draw only rebinds the set that changed.
+//The set of each frequency is the next set index (after the bindless set), the unused frequencies at the end take no set
+enum class SetFrequency : uint32_t {
+    PerFrame = 0,       //Camera, lights...
+    PerMaterial = 1,    //Textures, material parameters...
+    PerDraw = 2         //Object data, usually dynamic uniforms
+};
 
 struct UniformInformations {
     uint32_t binding;
     VkDeviceSize bufferSize;
     VkShaderStageFlags flags;
+
+    //Default: everything in one set, like a single set shader
+    SetFrequency frequency = SetFrequency::PerFrame;
+};
+
+//Resource changing at each draw, given to Shader::bindPerDraw
+struct PerDrawBindingInformations {
+    uint32_t binding;
+    VkDescriptorType type;
+    VkShaderStageFlags flags;
+};
+
+//bufferInfo for the uniform and storage buffers, imageInfo for the combined image samplers and storage images
+struct PerDrawDescriptor {
+    uint32_t binding;
+    VkDescriptorBufferInfo bufferInfo;
+    VkDescriptorImageInfo imageInfo;
+};
+
+//Buffer owned outside of the shader: one buffer info for all the frames, or one per frame in flight
+struct StorageBufferInformations {
+    uint32_t binding;
+    VkShaderStageFlags flags;
+    std::vector<VkDescriptorBufferInfo> buffers;
+    SetFrequency frequency = SetFrequency::PerFrame;
+};
+
+//Image view owned outside of the shader, in the VK_IMAGE_LAYOUT_GENERAL layout: one view for all the frames, or one per frame in flight
+struct StorageImageInformations {
+    uint32_t binding;
+    VkShaderStageFlags flags;
+    std::vector<VkImageView> imageViews;
+    SetFrequency frequency = SetFrequency::PerFrame;
+};
+
+//Resource given by each Material using the shader, in the per material set
+struct MaterialBindingInformations {
+    uint32_t binding;
+    VkDescriptorType type; //VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER (parameter block) or VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    VkShaderStageFlags flags;
+    VkDeviceSize bufferSize = 0; //Size of the parameter block
 };
 
 struct PushConstantInformations {
@@ -68,28 +126,26 @@ struct UniformBufferWrapper {
 class Shader {
 
     public:
-        Shader(const Device* device, uint16_t nbFrames, const std::string& vertexFilename, const std::string& fragmentFilename)
-            : device_(device), nbFrames_(nbFrames), vertexFilename_(vertexFilename), fragmentFilename_(fragmentFilename) {}
+        Shader(const Device* device, DescriptorAllocator* descriptorAllocator, LayoutCache* layoutCache, uint16_t nbFrames, const std::string& vertexFilename, const std::string& fragmentFilename)
+            : device_(device), descriptorAllocator_(descriptorAllocator), layoutCache_(layoutCache), nbFrames_(nbFrames), vertexFilename_(vertexFilename), fragmentFilename_(fragmentFilename) {}
+
+        //Compute shader, used by a ComputePipeline
+        Shader(const Device* device, DescriptorAllocator* descriptorAllocator, LayoutCache* layoutCache, uint16_t nbFrames, const std::string& computeFilename)
+            : device_(device), descriptorAllocator_(descriptorAllocator), layoutCache_(layoutCache), bindPoint_(VK_PIPELINE_BIND_POINT_COMPUTE), nbFrames_(nbFrames), computeFilename_(computeFilename) {}
 
         ~Shader() {
             
             for (UniformBufferWrapper& uniformBufferWrapper : uniformBufferWrappers_)
                 uniformBufferWrapper.deallocate(device_->getAllocator());
 
-            if(descriptorPool_){
-                vkDestroyDescriptorPool(device_->get(), descriptorPool_, nullptr);
-                descriptorPool_ = nullptr;
+            for (FrequencySet& frequencySet : frequencySets_) {
+                if (!frequencySet.sets.empty()) {
+                    descriptorAllocator_->free(frequencySet.sets);
+                    frequencySet.sets.clear();
+                }
             }
 
-            if(descriptorSetLayout_){
-                vkDestroyDescriptorSetLayout(device_->get(), descriptorSetLayout_, nullptr);
-                descriptorSetLayout_ = nullptr;
-            }
-            
-            if(pipelineLayout_){
-		        vkDestroyPipelineLayout(device_->get(), pipelineLayout_, nullptr);
-                pipelineLayout_ = nullptr;
-            }
+            //The layouts are owned by the layout cache
 
         }
 
@@ -124,23 +180,116 @@ class Shader {
 
         }
 
-        void addTexture(VkCommandPool commandPool, VkQueue queue, std::vector<uint8_t> const& texture, Texture::TextureInformations const& textureInformations) {
+        //Uniforms written per draw in the uniform ring, bound with dynamic offsets.
+        //bind takes one offset per dynamic uniform, in the order of their bindings
+        void addDynamicUniformBufferObjects(UniformRing const& uniformRing, std::vector<UniformInformations> const& uniformsInformation) {
+
+            uniformRing_ = &uniformRing;
+            dynamicUniforms_.insert(dynamicUniforms_.end(), uniformsInformation.begin(), uniformsInformation.end());
+
+            //Vulkan applies the dynamic offsets by set then by binding order
+            std::sort(dynamicUniforms_.begin(), dynamicUniforms_.end(), [](UniformInformations const& a, UniformInformations const& b) { return a.frequency < b.frequency || (a.frequency == b.frequency && a.binding < b.binding); });
+
+        }
+
+        //The per draw bindings get their own set, after the sets of this shader.
+        //Pushed in the command buffer with VK_KHR_push_descriptor, or written in a transient set without it
+        void addPerDrawBindings(std::vector<PerDrawBindingInformations> const& bindingsInformations) {
+
+            //Only the types written by bindPerDraw and available in the transient pools of the fallback
+            for (PerDrawBindingInformations const& bindingInformations : bindingsInformations) {
+                switch (bindingInformations.type) {
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                        break;
+                    default:
+                        throw std::runtime_error("Unsupported descriptor type for a per draw binding !");
+                }
+            }
+
+            perDrawBindings_.insert(perDrawBindings_.end(), bindingsInformations.begin(), bindingsInformations.end());
+
+        }
+
+        //Storage buffers read or written by the shader (compute results, indirect commands...)
+        void addStorageBuffers(std::vector<StorageBufferInformations> const& storageBuffers) {
+
+            for (StorageBufferInformations const& storageBuffer : storageBuffers) {
+                if (storageBuffer.buffers.size() != 1 && storageBuffer.buffers.size() != nbFrames_) {
+                    throw std::runtime_error("A storage buffer needs one buffer or one per frame !");
+                }
+            }
+
+            storageBuffers_.insert(storageBuffers_.end(), storageBuffers.begin(), storageBuffers.end());
+
+        }
+
+        void addStorageImages(std::vector<StorageImageInformations> const& storageImages) {
+
+            for (StorageImageInformations const& storageImage : storageImages) {
+                if (storageImage.imageViews.size() != 1 && storageImage.imageViews.size() != nbFrames_) {
+                    throw std::runtime_error("A storage image needs one view or one per frame !");
+                }
+            }
+
+            storageImages_.insert(storageImages_.end(), storageImages.begin(), storageImages.end());
+
+        }
+
+        //The per material set is described by the shader and its sets are owned by the materials (see Material).
+        //The resources of the shader can't be in the per material set then
+        void addMaterialBindings(std::vector<MaterialBindingInformations> const& bindingsInformations) {
+
+            for (MaterialBindingInformations const& bindingInformations : bindingsInformations) {
+                if (bindingInformations.type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && bindingInformations.type != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+                    throw std::runtime_error("Unsupported material binding type !");
+                }
+            }
+
+            materialBindings_.insert(materialBindings_.end(), bindingsInformations.begin(), bindingsInformations.end());
+
+        }
+
+        //The bindless textures take the set 0 and the sets of this shader move by 1 (in GLSL too).
+        //Must be called before generateBindingsAndSets, the set is bound once per frame by the wrapper
+        void useBindlessTextures(BindlessTextures const& bindlessTextures) {
+            bindlessSetLayout_ = bindlessTextures.getSetLayout();
+            setIndex_ = 1;
+        }
+
+        //Default constants of the pipelines using this shader, the pipelines can override them
+        void setSpecializationConstants(VkShaderStageFlagBits stage, SpecializationConstants const& constants) {
+            if (stage == VK_SHADER_STAGE_VERTEX_BIT) {
+                specialization_.vertex = constants;
+            } else if (stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+                specialization_.fragment = constants;
+            } else if (stage == VK_SHADER_STAGE_COMPUTE_BIT) {
+                computeSpecialization_ = constants;
+            } else {
+                throw std::runtime_error("Specialization constants of an unsupported shader stage !");
+            }
+        }
+
+        void addTexture(UploadManager& uploadManager, std::vector<uint8_t> const& texture, Texture::TextureInformations const& textureInformations, SetFrequency frequency = SetFrequency::PerFrame) {
 
             textures_.emplace_back(
-                device_, commandPool, queue,
+                device_, uploadManager,
                 texture, textureInformations
             );
+            textureFrequencies_.push_back(frequency);
             
         }
 
-        void addTexture(Texture&& texture) {
+        void addTexture(Texture&& texture, SetFrequency frequency = SetFrequency::PerFrame) {
             textures_.emplace_back(std::move(texture));
+            textureFrequencies_.push_back(frequency);
         }
 
         void generateBindingsAndSets() {
             createDescriptorSetLayout();
             createPipelineLayout();
-            createDescriptorPool();
             createDescriptorSets();
         }
 
@@ -148,172 +297,243 @@ class Shader {
         //CPU
         void createDescriptorSetLayout() {
 
-            std::vector<VkDescriptorSetLayoutBinding> layoutBindings(nbUniforms_ + textures_.size());
+            std::array<std::vector<VkDescriptorSetLayoutBinding>, SET_FREQUENCY_COUNT> layoutBindings;
 
             // Set the uniforms layout bindings
-            for (size_t i = 0; i < nbUniforms_; ++i) {
+            for (UniformBufferWrapper const& uniformBufferWrapper : uniformBufferWrappers_) {
+                UniformInformations const& informations = uniformBufferWrapper.informations;
+                layoutBindings[frequencyIndex(informations.frequency)].push_back(createLayoutBinding(informations.binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, informations.flags));
+            }
 
-                layoutBindings[i].binding = uniformBufferWrappers_[i].informations.binding;
-                layoutBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                layoutBindings[i].descriptorCount = 1; //If array, put more than 1
-                layoutBindings[i].pImmutableSamplers = nullptr; // Optional
+            // Set the texture layout bindings
+            for (size_t i = 0; i < textures_.size(); ++i) {
+                Texture::TextureInformations const& currentTextureInformations = textures_[i].getInformations();
+                layoutBindings[frequencyIndex(textureFrequencies_[i])].push_back(createLayoutBinding(currentTextureInformations.binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, currentTextureInformations.flags));
+            }
 
-                // Precise in which shader we will use the uniform
-                layoutBindings[i].stageFlags = uniformBufferWrappers_[i].informations.flags;
+            // Set the dynamic uniforms layout bindings
+            for (UniformInformations const& dynamicUniform : dynamicUniforms_) {
+                layoutBindings[frequencyIndex(dynamicUniform.frequency)].push_back(createLayoutBinding(dynamicUniform.binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, dynamicUniform.flags));
+                frequencySets_[frequencyIndex(dynamicUniform.frequency)].dynamicCount++;
+            }
 
+            // Set the storage layout bindings
+            for (StorageBufferInformations const& storageBuffer : storageBuffers_) {
+                layoutBindings[frequencyIndex(storageBuffer.frequency)].push_back(createLayoutBinding(storageBuffer.binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffer.flags));
             }
 
-            // Set the texture layout bindings
-            for (size_t i = 0; i < textures_.size(); ++i) {
-                
-                size_t currentIndex = nbUniforms_ + i;
+            for (StorageImageInformations const& storageImage : storageImages_) {
+                layoutBindings[frequencyIndex(storageImage.frequency)].push_back(createLayoutBinding(storageImage.binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, storageImage.flags));
+            }
 
-                Texture::TextureInformations const& currentTextureInformations = textures_[i].getInformations();
+            // Set the material layout bindings, the materials allocate the sets
+            if (!materialBindings_.empty()) {
 
-                layoutBindings[currentIndex].binding = currentTextureInformations.binding;
-                layoutBindings[currentIndex].descriptorCount = 1;
-                layoutBindings[currentIndex].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                layoutBindings[currentIndex].pImmutableSamplers = nullptr;
+                std::vector<VkDescriptorSetLayoutBinding>& materialLayoutBindings = layoutBindings[frequencyIndex(SetFrequency::PerMaterial)];
+                if (!materialLayoutBindings.empty()) {
+                    throw std::runtime_error("The per material set of a shader with material bindings can only have material bindings !");
+                }
 
-                // Precise in which shader we will use the texture
-                layoutBindings[currentIndex].stageFlags = currentTextureInformations.flags;
+                for (MaterialBindingInformations const& materialBinding : materialBindings_) {
+                    materialLayoutBindings.push_back(createLayoutBinding(materialBinding.binding, materialBinding.type, materialBinding.flags));
+                }
 
             }
 
-            VkDescriptorSetLayoutCreateInfo layoutInfo{};
-            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
-            layoutInfo.pBindings = layoutBindings.data();
+            //The sets go up to the last used frequency, an unused set before it gets an empty layout
+            frequencyCount_ = 0;
+            for (size_t frequency = 0; frequency < SET_FREQUENCY_COUNT; ++frequency) {
+                if (!layoutBindings[frequency].empty()) frequencyCount_ = static_cast<uint32_t>(frequency + 1);
+            }
 
-            if (vkCreateDescriptorSetLayout(device_->get(), &layoutInfo, nullptr, &descriptorSetLayout_) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create a descriptor set !");
+            //Shared with the shaders having the same bindings
+            for (size_t frequency = 0; frequency < frequencyCount_; ++frequency) {
+                frequencySets_[frequency].layout = layoutCache_->getSetLayout(layoutBindings[frequency]);
             }
 
+            if (!perDrawBindings_.empty()) createPerDrawSetLayout();
+
         }
 
         void createPipelineLayout() {
 
-            VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-            pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-            pipelineLayoutInfo.setLayoutCount = 1;
-            pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout_;
+            std::vector<VkPushConstantRange> pushConstantRanges;
+            if (pushConstantRange_) pushConstantRanges.push_back(*pushConstantRange_);
 
-            if (pushConstantRange_) {
-                pipelineLayoutInfo.pushConstantRangeCount = 1;    // Optional
-                pipelineLayoutInfo.pPushConstantRanges = &(*pushConstantRange_); // Optional
-            }
-            else {
-                pipelineLayoutInfo.pushConstantRangeCount = 0;    // Optional
-                pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+            //Shared with the shaders having the same layouts, so the pipelines built from them are shared too.
+            //Two shaders with the same first sets keep them bound when switching between their pipelines
+            std::vector<VkDescriptorSetLayout> setLayouts;
+            if (bindlessSetLayout_) setLayouts.push_back(bindlessSetLayout_);
+            for (size_t frequency = 0; frequency < frequencyCount_; ++frequency) {
+                setLayouts.push_back(frequencySets_[frequency].layout);
             }
+            if (perDrawSetLayout_) setLayouts.push_back(perDrawSetLayout_);
 
-            if (vkCreatePipelineLayout(device_->get(), &pipelineLayoutInfo, nullptr, &pipelineLayout_) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create the pipeline layout !");
-            }
+            pipelineLayout_ = layoutCache_->getPipelineLayout(setLayouts, pushConstantRanges);
         }
 
         //GPU
-        void createDescriptorPool() {
+        void createDescriptorSets() {
 
-            std::vector<VkDescriptorPoolSize> poolSizes;
-            if (nbUniforms_ > 0) {
-                poolSizes.emplace_back();
-                poolSizes.back().type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                poolSizes.back().descriptorCount = static_cast<uint32_t>(nbUniforms_ * nbFrames_);
-            }
+            for (size_t frequency = 0; frequency < frequencyCount_; ++frequency) {
 
-            if (!textures_.empty()) {
-                poolSizes.emplace_back();
-                poolSizes.back().type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                poolSizes.back().descriptorCount = static_cast<uint32_t>(textures_.size() * nbFrames_);
-            }
-            
+                FrequencySet& frequencySet = frequencySets_[frequency];
 
-            VkDescriptorPoolCreateInfo poolInfo{};
-            poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            
-            poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-            poolInfo.pPoolSizes = poolSizes.data();
+                std::vector<UniformBufferWrapper const*> uniforms;
+                for (UniformBufferWrapper const& uniformBufferWrapper : uniformBufferWrappers_) {
+                    if (frequencyIndex(uniformBufferWrapper.informations.frequency) == frequency) uniforms.push_back(&uniformBufferWrapper);
+                }
 
-            //Note: This represent the max values of set that we can allocate.
-            //A set is a "set of uniforms" that the shaders will have access to. So here we create 1 set for each frame.
-            poolInfo.maxSets = static_cast<uint32_t>(nbFrames_);
+                std::vector<size_t> textureIndices;
+                for (size_t textureIndex = 0; textureIndex < textures_.size(); ++textureIndex) {
+                    if (frequencyIndex(textureFrequencies_[textureIndex]) == frequency) textureIndices.push_back(textureIndex);
+                }
 
-            if (vkCreateDescriptorPool(device_->get(), &poolInfo, nullptr, &descriptorPool_) != VK_SUCCESS) {
-                throw std::runtime_error("failed to create descriptor pool !");
-            }
+                std::vector<UniformInformations const*> dynamicUniforms;
+                for (UniformInformations const& dynamicUniform : dynamicUniforms_) {
+                    if (frequencyIndex(dynamicUniform.frequency) == frequency) dynamicUniforms.push_back(&dynamicUniform);
+                }
 
-        }
+                std::vector<StorageBufferInformations const*> storageBuffers;
+                for (StorageBufferInformations const& storageBuffer : storageBuffers_) {
+                    if (frequencyIndex(storageBuffer.frequency) == frequency) storageBuffers.push_back(&storageBuffer);
+                }
 
-        void createDescriptorSets() {
+                std::vector<StorageImageInformations const*> storageImages;
+                for (StorageImageInformations const& storageImage : storageImages_) {
+                    if (frequencyIndex(storageImage.frequency) == frequency) storageImages.push_back(&storageImage);
+                }
 
-            std::vector<VkDescriptorSetLayout> layouts(nbFrames_, descriptorSetLayout_);
+                //Nothing to bind
+                if (uniforms.empty() && textureIndices.empty() && dynamicUniforms.empty() && storageBuffers.empty() && storageImages.empty()) continue;
 
-            VkDescriptorSetAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            allocInfo.descriptorPool = descriptorPool_;
-            allocInfo.descriptorSetCount = static_cast<uint32_t>(nbFrames_);
-            allocInfo.pSetLayouts = layouts.data();
+                //One set per frame when a resource has one per frame, else one set for all the frames
+                bool perFrame = !uniforms.empty();
+                for (StorageBufferInformations const* storageBuffer : storageBuffers) perFrame |= storageBuffer->buffers.size() > 1;
+                for (StorageImageInformations const* storageImage : storageImages) perFrame |= storageImage->imageViews.size() > 1;
 
-            descriptorSets_.resize(nbFrames_);
-            if (vkAllocateDescriptorSets(device_->get(), &allocInfo, descriptorSets_.data()) != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate descriptor sets !");
-            }
+                frequencySet.sets.resize(perFrame ? nbFrames_ : 1);
+                for (VkDescriptorSet& descriptorSet : frequencySet.sets) {
+                    descriptorSet = descriptorAllocator_->allocate(frequencySet.layout);
+                }
 
-            for (size_t frameIndex = 0; frameIndex < nbFrames_; frameIndex++) {
+                for (size_t frameIndex = 0; frameIndex < frequencySet.sets.size(); frameIndex++) {
 
-                std::vector<VkDescriptorBufferInfo> buffersInfos(nbUniforms_);
-                std::vector<VkDescriptorImageInfo> imagesInfos(textures_.size());
+                    VkDescriptorSet descriptorSet = frequencySet.sets[frameIndex];
 
-                std::vector<VkWriteDescriptorSet> writeDescriptors(nbUniforms_ + textures_.size());
-                
-                // Uniform descriptors
-                for (size_t uniformIndex = 0; uniformIndex < nbUniforms_; uniformIndex++) {
+                    std::vector<VkDescriptorBufferInfo> buffersInfos(uniforms.size());
+                    std::vector<VkDescriptorImageInfo> imagesInfos(textureIndices.size());
+                    std::vector<VkDescriptorBufferInfo> dynamicBuffersInfos(dynamicUniforms.size());
+                    std::vector<VkDescriptorImageInfo> storageImagesInfos(storageImages.size());
 
-                    UniformBufferWrapper const& uniformBufferWrapper = uniformBufferWrappers_[uniformIndex];
+                    std::vector<VkWriteDescriptorSet> writeDescriptors;
+                    writeDescriptors.reserve(uniforms.size() + textureIndices.size() + dynamicUniforms.size() + storageBuffers.size() + storageImages.size());
 
-                    // VkDescriptorBufferInfo bufferInfo{};
-                    buffersInfos[uniformIndex].buffer = uniformBufferWrapper.uniformBuffers[frameIndex];
-                    buffersInfos[uniformIndex].offset = 0;
-                    buffersInfos[uniformIndex].range = uniformBufferWrapper.informations.bufferSize;
+                    // Uniform descriptors
+                    for (size_t uniformIndex = 0; uniformIndex < uniforms.size(); uniformIndex++) {
 
-                    // VkWriteDescriptorSet descriptorWrite{};
-                    writeDescriptors[uniformIndex].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                    writeDescriptors[uniformIndex].dstSet = descriptorSets_[frameIndex];
-                    writeDescriptors[uniformIndex].dstBinding = uniformBufferWrapper.informations.binding; //Binding in shader
-                    writeDescriptors[uniformIndex].dstArrayElement = 0;
+                        UniformBufferWrapper const& uniformBufferWrapper = *uniforms[uniformIndex];
 
-                    writeDescriptors[uniformIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                    writeDescriptors[uniformIndex].descriptorCount = 1;
+                        buffersInfos[uniformIndex].buffer = uniformBufferWrapper.uniformBuffers[frameIndex];
+                        buffersInfos[uniformIndex].offset = 0;
+                        buffersInfos[uniformIndex].range = uniformBufferWrapper.informations.bufferSize;
 
-                    writeDescriptors[uniformIndex].pBufferInfo = &buffersInfos[uniformIndex];
+                        VkWriteDescriptorSet& writeDescriptor = writeDescriptors.emplace_back();
+                        writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                        writeDescriptor.dstSet = descriptorSet;
+                        writeDescriptor.dstBinding = uniformBufferWrapper.informations.binding; //Binding in shader
+                        writeDescriptor.dstArrayElement = 0;
 
-                }
+                        writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                        writeDescriptor.descriptorCount = 1;
 
-                // Texture descriptors
-                for (size_t textureIndex = 0; textureIndex < textures_.size(); ++textureIndex) {
-                    
-                    size_t currentIndex = nbUniforms_ + textureIndex;
+                        writeDescriptor.pBufferInfo = &buffersInfos[uniformIndex];
 
-                    Texture const& currentTexture = textures_[textureIndex];
+                    }
 
-                    imagesInfos[textureIndex].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    imagesInfos[textureIndex].imageView = currentTexture.getImageView();
-                    imagesInfos[textureIndex].sampler = currentTexture.getSampler();
+                    // Texture descriptors
+                    for (size_t i = 0; i < textureIndices.size(); ++i) {
 
-                    writeDescriptors[currentIndex].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                    writeDescriptors[currentIndex].dstSet = descriptorSets_[frameIndex];
-                    writeDescriptors[currentIndex].dstBinding = currentTexture.getInformations().binding;
-                    writeDescriptors[currentIndex].dstArrayElement = 0;
+                        Texture const& currentTexture = textures_[textureIndices[i]];
 
-                    writeDescriptors[currentIndex].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                    writeDescriptors[currentIndex].descriptorCount = 1;
+                        imagesInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                        imagesInfos[i].imageView = currentTexture.getImageView();
+                        imagesInfos[i].sampler = currentTexture.getSampler();
 
-                    writeDescriptors[currentIndex].pImageInfo = &imagesInfos[textureIndex];
+                        VkWriteDescriptorSet& writeDescriptor = writeDescriptors.emplace_back();
+                        writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                        writeDescriptor.dstSet = descriptorSet;
+                        writeDescriptor.dstBinding = currentTexture.getInformations().binding;
+                        writeDescriptor.dstArrayElement = 0;
 
-                }
+                        writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                        writeDescriptor.descriptorCount = 1;
+
+                        writeDescriptor.pImageInfo = &imagesInfos[i];
+
+                    }
+
+                    // Dynamic uniform descriptors, the whole ring is visible and the offset is given when binding
+                    for (size_t dynamicIndex = 0; dynamicIndex < dynamicUniforms.size(); ++dynamicIndex) {
+
+                        dynamicBuffersInfos[dynamicIndex].buffer = uniformRing_->getBuffer();
+                        dynamicBuffersInfos[dynamicIndex].offset = 0;
+                        dynamicBuffersInfos[dynamicIndex].range = dynamicUniforms[dynamicIndex]->bufferSize;
+
+                        VkWriteDescriptorSet& writeDescriptor = writeDescriptors.emplace_back();
+                        writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                        writeDescriptor.dstSet = descriptorSet;
+                        writeDescriptor.dstBinding = dynamicUniforms[dynamicIndex]->binding;
+                        writeDescriptor.dstArrayElement = 0;
+
+                        writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                        writeDescriptor.descriptorCount = 1;
+
+                        writeDescriptor.pBufferInfo = &dynamicBuffersInfos[dynamicIndex];
+
+                    }
+
+                    // Storage buffer descriptors
+                    for (StorageBufferInformations const* storageBuffer : storageBuffers) {
+
+                        VkWriteDescriptorSet& writeDescriptor = writeDescriptors.emplace_back();
+                        writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                        writeDescriptor.dstSet = descriptorSet;
+                        writeDescriptor.dstBinding = storageBuffer->binding;
+                        writeDescriptor.dstArrayElement = 0;
+
+                        writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                        writeDescriptor.descriptorCount = 1;
 
-                vkUpdateDescriptorSets(device_->get(), static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data(), 0, nullptr);
+                        writeDescriptor.pBufferInfo = &storageBuffer->buffers[frameIndex % storageBuffer->buffers.size()];
+
+                    }
+
+                    // Storage image descriptors
+                    for (size_t imageIndex = 0; imageIndex < storageImages.size(); ++imageIndex) {
+
+                        StorageImageInformations const& storageImage = *storageImages[imageIndex];
+
+                        storageImagesInfos[imageIndex].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                        storageImagesInfos[imageIndex].imageView = storageImage.imageViews[frameIndex % storageImage.imageViews.size()];
+                        storageImagesInfos[imageIndex].sampler = VK_NULL_HANDLE;
+
+                        VkWriteDescriptorSet& writeDescriptor = writeDescriptors.emplace_back();
+                        writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                        writeDescriptor.dstSet = descriptorSet;
+                        writeDescriptor.dstBinding = storageImage.binding;
+                        writeDescriptor.dstArrayElement = 0;
+
+                        writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                        writeDescriptor.descriptorCount = 1;
+
+                        writeDescriptor.pImageInfo = &storageImagesInfos[imageIndex];
+
+                    }
+
+                    vkUpdateDescriptorSets(device_->get(), static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data(), 0, nullptr);
+
+                }
 
             }
 
@@ -324,8 +544,39 @@ class Shader {
             vkCmdPushConstants(commandBuffer, pipelineLayout_, pushConstantRange_->stageFlags, 0, dataSize, data);
         }
 
-        inline void bind(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_, 0, 1, &descriptorSets_[frameIndex], 0, nullptr);
+        //Bind all the sets of this shader.
+        //dynamicOffsets: the offsets returned by the uniform ring, one per dynamic uniform ordered by set then by binding
+        inline void bind(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::span<const uint32_t> dynamicOffsets = {}) const {
+
+            size_t offsetIndex = 0;
+            for (size_t frequency = 0; frequency < frequencyCount_; ++frequency) {
+                uint32_t dynamicCount = frequencySets_[frequency].dynamicCount;
+                if (offsetIndex + dynamicCount > dynamicOffsets.size()) {
+                    throw std::runtime_error("One dynamic offset per dynamic uniform is required !");
+                }
+
+                bindSet(commandBuffer, static_cast<SetFrequency>(frequency), frameIndex, dynamicOffsets.subspan(offsetIndex, dynamicCount));
+                offsetIndex += dynamicCount;
+            }
+
+        }
+
+        //Bind only the set of this frequency, the other sets stay bound.
+        //dynamicOffsets: one per dynamic uniform of this set, in binding order
+        inline void bindSet(VkCommandBuffer commandBuffer, SetFrequency frequency, uint32_t frameIndex, std::span<const uint32_t> dynamicOffsets = {}) const {
+
+            FrequencySet const& frequencySet = frequencySets_[frequencyIndex(frequency)];
+
+            //Nothing in this set
+            if (frequencySet.sets.empty()) return;
+
+            if (dynamicOffsets.size() != frequencySet.dynamicCount) {
+                throw std::runtime_error("One dynamic offset per dynamic uniform of the set is required !");
+            }
+
+            VkDescriptorSet descriptorSet = frequencySet.sets[frameIndex % frequencySet.sets.size()];
+            vkCmdBindDescriptorSets(commandBuffer, bindPoint_, pipelineLayout_, getDescriptorSetIndex(frequency), 1, &descriptorSet, static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+
         }
 
         inline void updateUniform(size_t uniformIndex, uint32_t frameIndex, void * data, size_t dataSize) const {
@@ -344,21 +595,171 @@ class Shader {
             return fragmentFilename_;
         }
 
+        inline std::string const& getComputeFilename() const {
+            return computeFilename_;
+        }
+
+        inline bool isCompute() const {
+            return bindPoint_ == VK_PIPELINE_BIND_POINT_COMPUTE;
+        }
+
+        inline VkPipelineBindPoint getBindPoint() const {
+            return bindPoint_;
+        }
+
+        //Bind the resources of the next draw (every per draw binding must be given)
+        void bindPerDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<PerDrawDescriptor> const& descriptors) const {
+
+            std::vector<VkWriteDescriptorSet> writeDescriptors(descriptors.size());
+
+            for (size_t i = 0; i < descriptors.size(); ++i) {
+
+                VkDescriptorType type = getPerDrawType(descriptors[i].binding);
+                bool isBuffer = type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+                writeDescriptors[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptors[i].dstBinding = descriptors[i].binding;
+                writeDescriptors[i].dstArrayElement = 0;
+                writeDescriptors[i].descriptorType = type;
+                writeDescriptors[i].descriptorCount = 1;
+
+                if (isBuffer) writeDescriptors[i].pBufferInfo = &descriptors[i].bufferInfo;
+                else writeDescriptors[i].pImageInfo = &descriptors[i].imageInfo;
+
+            }
+
+            uint32_t perDrawSetIndex = getPerDrawSetIndex();
+
+            //No set: the descriptors are recorded in the command buffer
+            if (device_->supportsPushDescriptors()) {
+                device_->cmdPushDescriptorSet(commandBuffer, bindPoint_, pipelineLayout_, perDrawSetIndex, static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data());
+                return;
+            }
+
+            //Fallback: a set freed with the transient pools of the frame
+            VkDescriptorSet descriptorSet = descriptorAllocator_->allocateTransient(frameIndex, perDrawSetLayout_);
+            for (VkWriteDescriptorSet& writeDescriptor : writeDescriptors) writeDescriptor.dstSet = descriptorSet;
+
+            vkUpdateDescriptorSets(device_->get(), static_cast<uint32_t>(writeDescriptors.size()), writeDescriptors.data(), 0, nullptr);
+            vkCmdBindDescriptorSets(commandBuffer, bindPoint_, pipelineLayout_, perDrawSetIndex, 1, &descriptorSet, 0, nullptr);
+
+        }
+
+        //Set index of the uniforms and textures of this frequency (in GLSL: layout(set = ...))
+        inline uint32_t getDescriptorSetIndex(SetFrequency frequency = SetFrequency::PerFrame) const {
+            return setIndex_ + static_cast<uint32_t>(frequency);
+        }
+
+        //Created by createDescriptorSetLayout, nullptr when the frequency has no set
+        inline VkDescriptorSetLayout getSetLayout(SetFrequency frequency) const {
+            return frequencySets_[frequencyIndex(frequency)].layout;
+        }
+
+        inline std::vector<MaterialBindingInformations> const& getMaterialBindings() const {
+            return materialBindings_;
+        }
+
+        //Set index of the bindings given to bindPerDraw, after the last used frequency
+        inline uint32_t getPerDrawSetIndex() const {
+            return setIndex_ + frequencyCount_;
+        }
+
+        inline PipelineSpecialization const& getSpecialization() const {
+            return specialization_;
+        }
+
+        inline SpecializationConstants const& getComputeSpecialization() const {
+            return computeSpecialization_;
+        }
+
     private:
 
+        static constexpr size_t SET_FREQUENCY_COUNT = 3;
+
+        //Layout and sets of one frequency
+        struct FrequencySet {
+            VkDescriptorSetLayout layout = nullptr;
+
+            //One per frame in flight, or one for all the frames without uniform buffers. Empty if nothing is in the set
+            std::vector<VkDescriptorSet> sets;
+
+            uint32_t dynamicCount = 0;
+        };
+
+        static size_t frequencyIndex(SetFrequency frequency) {
+            return static_cast<size_t>(frequency);
+        }
+
+        static VkDescriptorSetLayoutBinding createLayoutBinding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags flags) {
+            VkDescriptorSetLayoutBinding layoutBinding{};
+            layoutBinding.binding = binding;
+            layoutBinding.descriptorType = type;
+            layoutBinding.descriptorCount = 1; //If array, put more than 1
+            layoutBinding.pImmutableSamplers = nullptr; // Optional
+
+            // Precise in which shader we will use the resource
+            layoutBinding.stageFlags = flags;
+            return layoutBinding;
+        }
+
+        void createPerDrawSetLayout() {
+
+            std::vector<VkDescriptorSetLayoutBinding> layoutBindings(perDrawBindings_.size());
+
+            for (size_t i = 0; i < perDrawBindings_.size(); ++i) {
+                layoutBindings[i].binding = perDrawBindings_[i].binding;
+                layoutBindings[i].descriptorType = perDrawBindings_[i].type;
+                layoutBindings[i].descriptorCount = 1;
+                layoutBindings[i].pImmutableSamplers = nullptr;
+                layoutBindings[i].stageFlags = perDrawBindings_[i].flags;
+            }
+
+            VkDescriptorSetLayoutCreateFlags flags = device_->supportsPushDescriptors() ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
+            perDrawSetLayout_ = layoutCache_->getSetLayout(layoutBindings, flags);
+
+        }
+
+        VkDescriptorType getPerDrawType(uint32_t binding) const {
+            for (PerDrawBindingInformations const& bindingInformations : perDrawBindings_) {
+                if (bindingInformations.binding == binding) return bindingInformations.type;
+            }
+
+            throw std::runtime_error("Unknown per draw binding !");
+        }
+
         //Vulkan objects
         const Device* device_;
+        DescriptorAllocator* descriptorAllocator_;
+        LayoutCache* layoutCache_;
+
+        //Graphics, or compute with a compute file
+        VkPipelineBindPoint bindPoint_ = VK_PIPELINE_BIND_POINT_GRAPHICS;
 
-        //Vulkan uniforms objects
-        VkDescriptorSetLayout descriptorSetLayout_ = nullptr;
-        VkDescriptorPool descriptorPool_ = nullptr;
-        std::vector<VkDescriptorSet> descriptorSets_;
+        //Vulkan uniforms objects, one set per used frequency starting at setIndex_
+        std::array<FrequencySet, SET_FREQUENCY_COUNT> frequencySets_;
+        uint32_t frequencyCount_ = 0;
+        uint32_t setIndex_ = 0;
+
+        //Per draw resources, in the set after the sets of this shader
+        std::vector<PerDrawBindingInformations> perDrawBindings_;
+        VkDescriptorSetLayout perDrawSetLayout_ = nullptr;
+
+        //Per material resources, given by the materials
+        std::vector<MaterialBindingInformations> materialBindings_;
+
+        //Set 0 when the bindless textures are used
+        VkDescriptorSetLayout bindlessSetLayout_ = nullptr;
         VkPipelineLayout pipelineLayout_ = nullptr;
 
         //Shader variables
         uint16_t nbFrames_;
         std::string vertexFilename_;
         std::string fragmentFilename_;
+        std::string computeFilename_;
+
+        //Default specialization constants
+        PipelineSpecialization specialization_;
+        SpecializationConstants computeSpecialization_;
 
         //Push constant memory
         std::optional<VkPushConstantRange> pushConstantRange_;
@@ -367,7 +768,16 @@ class Shader {
         std::vector<UniformBufferWrapper> uniformBufferWrappers_;
         size_t nbUniforms_ = 0;
 
+        //Dynamic uniforms memory, sorted by set then by binding
+        const UniformRing* uniformRing_ = nullptr;
+        std::vector<UniformInformations> dynamicUniforms_;
+
         //Texture memory
         std::vector<Texture> textures_;
+        std::vector<SetFrequency> textureFrequencies_;
+
+        //Storage resources, owned outside of the shader
+        std::vector<StorageBufferInformations> storageBuffers_;
+        std::vector<StorageImageInformations> storageImages_;
 
 };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Helper/MappedFile.hpp>
+#include <VulkanObjects/Helper/Hash.hpp>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstring>
+#include <unordered_map>
+#include <stdexcept>
+
+//SPIR-V code and VkShaderModule loaded once per file and shared by all the pipelines.
+//Indexed by path, then by content hash so two files with the same code share their module.
+//Thread safe, the pipelines can be built from several threads.
+class ShaderModuleCache {
+
+    public:
+        ShaderModuleCache(Device const& device) : devicePtr_(device.get()) {};
+
+        ~ShaderModuleCache() {
+            for (auto& [hash, modules] : modulesByHash_) {
+                for (std::unique_ptr<Module>& module : modules) {
+                    vkDestroyShaderModule(devicePtr_, module->shaderModule, nullptr);
+                }
+            }
+        }
+
+        ShaderModuleCache(ShaderModuleCache&&) = delete; //TODO: Declarer un move constructor
+        ShaderModuleCache& operator=(ShaderModuleCache&&) = delete;
+
+        ShaderModuleCache(const ShaderModuleCache&) = delete;
+        ShaderModuleCache& operator=(const ShaderModuleCache&) = delete;
+
+        //The file is only read the first time
+        VkShaderModule get(std::string const& filename) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return load(filename).shaderModule;
+        }
+
+        //The code stays valid as long as the cache
+        std::vector<uint32_t> const& getCode(std::string const& filename) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return load(filename).code;
+        }
+
+        //Read again the file, for example if it was compiled again. Return true if its content changed.
+        //Note: the previous module is kept, pipelines already created with it are still valid
+        bool reload(std::string const& filename) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto found = modulesByPath_.find(filename);
+            const Module* previous = found == modulesByPath_.end() ? nullptr : found->second;
+
+            if (found != modulesByPath_.end()) modulesByPath_.erase(found);
+
+            return &load(filename) != previous;
+        }
+
+        size_t getModuleCount() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            size_t count = 0;
+            for (auto const& [hash, modules] : modulesByHash_) count += modules.size();
+            return count;
+        }
+
+    private:
+
+        struct Module {
+            std::vector<uint32_t> code;
+            VkShaderModule shaderModule;
+        };
+
+        //The mutex must be locked
+        Module const& load(std::string const& filename) {
+
+            auto found = modulesByPath_.find(filename);
+            if (found != modulesByPath_.end()) return *found->second;
+
+            MappedFile file(filename);
+
+            if (file.size() == 0 || file.size() % sizeof(uint32_t) != 0) {
+                throw std::runtime_error(std::string {"Invalid SPIR-V file "} + filename + " !");
+            }
+
+            uint64_t hash = Hash::bytes(file.data(), file.size());
+            std::vector<std::unique_ptr<Module>>& modules = modulesByHash_[hash];
+
+            //Same content already loaded (the hash may collide, so the code is compared)
+            for (std::unique_ptr<Module>& module : modules) {
+                if (module->code.size() * sizeof(uint32_t) == file.size() && memcmp(module->code.data(), file.data(), file.size()) == 0) {
+                    modulesByPath_[filename] = module.get();
+                    return *module;
+                }
+            }
+
+            std::unique_ptr<Module> module = std::make_unique<Module>();
+            module->code.resize(file.size() / sizeof(uint32_t));
+            memcpy(module->code.data(), file.data(), file.size());
+
+            VkShaderModuleCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            createInfo.codeSize = file.size();
+            createInfo.pCode = module->code.data();
+
+            if (vkCreateShaderModule(devicePtr_, &createInfo, nullptr, &module->shaderModule) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create the shader module !");
+            }
+
+            modulesByPath_[filename] = module.get();
+            modules.push_back(std::move(module));
+
+            return *modules.back();
+
+        }
+
+        VkDevice devicePtr_;
+
+        mutable std::mutex mutex_;
+
+        std::unordered_map<std::string, const Module*> modulesByPath_;
+        std::unordered_map<uint64_t, std::vector<std::unique_ptr<Module>>> modulesByHash_;
+
+};
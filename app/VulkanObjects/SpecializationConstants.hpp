@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Helper/Hash.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+//Values of the specialization constants of one shader stage (layout(constant_id = X) const in GLSL).
+//Only the 32 bits scalars are supported, the 64 bits ones require device features.
+//Kept sorted by id, so two sets with the same values are equal whatever the order they were set.
+class SpecializationConstants {
+
+    public:
+
+        //Add or replace a constant, T is bool, int32_t, uint32_t or float
+        template<typename T>
+        SpecializationConstants& set(uint32_t constantID, T value) {
+            static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, float>, "Unsupported specialization constant type");
+
+            //A GLSL bool constant is a VkBool32
+            uint32_t bits;
+            if constexpr (std::is_same_v<T, bool>) {
+                bits = value ? VK_TRUE : VK_FALSE;
+            } else {
+                memcpy(&bits, &value, sizeof(bits));
+            }
+
+            auto found = std::lower_bound(constants_.begin(), constants_.end(), constantID, [](Constant const& constant, uint32_t id) { return constant.id < id; });
+
+            if (found != constants_.end() && found->id == constantID) {
+                found->bits = bits;
+            } else {
+                constants_.insert(found, {constantID, bits});
+            }
+
+            return *this;
+        }
+
+        //The constants of other replace the ones with the same id
+        SpecializationConstants& merge(SpecializationConstants const& other) {
+            for (Constant const& constant : other.constants_) set(constant.id, constant.bits);
+            return *this;
+        }
+
+        bool empty() const {
+            return constants_.empty();
+        }
+
+        bool operator==(SpecializationConstants const&) const = default;
+
+        void hash(uint64_t& hash) const {
+            Hash::combine(hash, constants_.size());
+            for (Constant const& constant : constants_) {
+                Hash::combine(hash, constant.id);
+                Hash::combine(hash, constant.bits);
+            }
+        }
+
+        //Filled from this object, which must outlive the VkSpecializationInfo
+        struct Info {
+            std::vector<VkSpecializationMapEntry> entries;
+            VkSpecializationInfo info{};
+        };
+
+        //nullptr in the stage info if there is no constant
+        void fill(Info& specializationInfo) const {
+
+            specializationInfo.entries.resize(constants_.size());
+
+            for (size_t i = 0; i < constants_.size(); ++i) {
+                specializationInfo.entries[i].constantID = constants_[i].id;
+                specializationInfo.entries[i].offset = static_cast<uint32_t>(i * sizeof(Constant) + offsetof(Constant, bits));
+                specializationInfo.entries[i].size = sizeof(uint32_t);
+            }
+
+            specializationInfo.info.mapEntryCount = static_cast<uint32_t>(specializationInfo.entries.size());
+            specializationInfo.info.pMapEntries = specializationInfo.entries.data();
+            specializationInfo.info.dataSize = constants_.size() * sizeof(Constant);
+            specializationInfo.info.pData = constants_.data();
+
+        }
+
+    private:
+
+        struct Constant {
+            uint32_t id;
+            uint32_t bits;
+
+            bool operator==(Constant const&) const = default;
+        };
+
+        std::vector<Constant> constants_;
+
+};
+
+//The specialization constants of each stage of a graphics pipeline
+struct PipelineSpecialization {
+    SpecializationConstants vertex;
+    SpecializationConstants fragment;
+
+    bool operator==(PipelineSpecialization const&) const = default;
+};
@@ -6,6 +6,7 @@
 #include <VulkanObjects/Surface.hpp>
 #include <VulkanObjects/Device.hpp>
 #include <VulkanObjects/RenderPass.hpp>
+#include <VulkanObjects/DeletionQueue.hpp>
 
 #include <VulkanObjects/Helper/SwapChainHelper.hpp>
 #include <VulkanObjects/Helper/Image.hpp>
@@ -59,7 +60,40 @@ class SwapChain {
 
         }
 
-        void initializeSwapChain(GLFWwindow* window, Surface const& surface, Device const& device) {
+        //Create a new swap chain from the old one, without waiting the device idle: the old images, views, framebuffers and swap chain
+        //are destroyed by the deletion queue once retireValue is completed. The framebuffers must then be initialized again.
+        void recreate(GLFWwindow* window, Surface const& surface, Device const& device, DeletionQueue& deletionQueue, uint64_t retireValue) {
+
+            VkSwapchainKHR oldSwapChain = swapChain_;
+            std::vector<VkImageView> oldImageViews = std::move(swapChainImageViews_);
+            std::vector<VkFramebuffer> oldFramebuffers = std::move(swapChainFramebuffers_);
+            swapChainImageViews_.clear();
+            swapChainFramebuffers_.clear();
+
+            VkImage oldDepthImage = depthImage_;
+            VmaAllocation oldDepthImageAllocation = depthImageAllocation_;
+            VkImageView oldDepthImageView = depthImageView_;
+
+            //The presentation engine can reuse the resources of the old swap chain
+            initializeSwapChain(window, surface, device, oldSwapChain);
+            initializeImageViews();
+            if (depthCheck_) initializeDepthResources(device);
+
+            deletionQueue.push(retireValue, [device = devicePtr_, allocator = allocatorPtr_, depthCheck = depthCheck_, oldSwapChain, oldImageViews, oldFramebuffers, oldDepthImage, oldDepthImageAllocation, oldDepthImageView]() {
+                for (VkFramebuffer framebuffer : oldFramebuffers) vkDestroyFramebuffer(device, framebuffer, nullptr);
+                for (VkImageView imageView : oldImageViews) vkDestroyImageView(device, imageView, nullptr);
+
+                if (depthCheck) {
+                    vkDestroyImageView(device, oldDepthImageView, nullptr);
+                    vmaDestroyImage(allocator, oldDepthImage, oldDepthImageAllocation);
+                }
+
+                vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+            });
+
+        }
+
+        void initializeSwapChain(GLFWwindow* window, Surface const& surface, Device const& device, VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE) {
 
             SwapChainHelper::SwapChainSupportDetails swapChainSupport = SwapChainHelper::querySwapChainSupport(device.getPhysical(), surface.get());
 
@@ -113,7 +147,7 @@ class SwapChain {
             createInfo.clipped = VK_TRUE; //If we want to ignore pixels that are obscured by other windows for example. True give the best performances
 
             //If the swap chain get recreated, we want to store here a pointer to the old one
-            createInfo.oldSwapchain = VK_NULL_HANDLE;
+            createInfo.oldSwapchain = oldSwapChain;
 
             // GENERATE the swap chain
             if (vkCreateSwapchainKHR(devicePtr_, &createInfo, nullptr, &swapChain_) != VK_SUCCESS) {
@@ -161,7 +195,7 @@ class SwapChain {
         }
 
         //Framebuffers
-        std::vector<VkFramebuffer> const& getFramebuffers() {
+        std::vector<VkFramebuffer> const& getFramebuffers() const {
             return swapChainFramebuffers_;
         }
 
@@ -197,9 +231,9 @@ class SwapChain {
 
         //Depth and stencil
         VkFormat depthFormat_;
-        VkImage depthImage_;
-        VmaAllocation depthImageAllocation_;
-        VkImageView depthImageView_;
+        VkImage depthImage_ = VK_NULL_HANDLE;
+        VmaAllocation depthImageAllocation_ = nullptr;
+        VkImageView depthImageView_ = VK_NULL_HANDLE;
 
         //Variable
         bool depthCheck_;
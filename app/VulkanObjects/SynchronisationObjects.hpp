@@ -4,17 +4,22 @@
 #include <vulkan/vulkan.h>
 
 #include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/GpuTimeline.hpp>
 
 #include <vector>
 #include <stdexcept>
 
 struct SynchronisationObjects {
 
+    //Binary semaphores, the swap chain can't use timeline semaphores
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
 
-    SynchronisationObjects(uint16_t framesInFlight, Device const& device) : devicePtr_(device.get()) {
+    //The frames are submitted on the graphics queue, a frame in flight is done once its value is completed
+    GpuTimeline frameTimeline;
+    std::vector<uint64_t> frameValues;
+
+    SynchronisationObjects(uint16_t framesInFlight, Device const& device) : frameTimeline(device, device.getGraphicsQueue()), frameValues(framesInFlight, 0), devicePtr_(device.get()) {
         initializeSyncObjects(framesInFlight);
         
     };
@@ -23,7 +28,6 @@ struct SynchronisationObjects {
         for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
 			vkDestroySemaphore(devicePtr_, renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(devicePtr_, imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(devicePtr_, inFlightFences[i], nullptr);
 		}
     }
 
@@ -40,20 +44,14 @@ struct SynchronisationObjects {
 
             imageAvailableSemaphores.resize(framesInFlight);
             renderFinishedSemaphores.resize(framesInFlight);
-            inFlightFences.resize(framesInFlight);
 
             VkSemaphoreCreateInfo semaphoreInfo{};
             semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-            VkFenceCreateInfo fenceInfo{};
-            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
             for (size_t i = 0; i < framesInFlight; i++) {
 
                 if (vkCreateSemaphore(devicePtr_, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-                    vkCreateSemaphore(devicePtr_, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-                    vkCreateFence(devicePtr_, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)  {
+                    vkCreateSemaphore(devicePtr_, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS)  {
 
                     throw std::runtime_error("Failed to create syncronization objects for a frame !");
                 }
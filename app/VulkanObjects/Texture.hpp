@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/UploadManager.hpp>
 #include <VulkanObjects/Helper/Buffer.hpp>
 #include <VulkanObjects/Helper/Image.hpp>
 
@@ -22,11 +23,11 @@ class Texture {
             VkShaderStageFlags flags;
         };
 
-        Texture(const Device* device, VkCommandPool commandPool, VkQueue queue,
+        Texture(const Device* device, UploadManager& uploadManager,
             std::vector<uint8_t> const& data, TextureInformations const& textureInformations)
-            : device_(device), size_(data.size()), textureInformations_(textureInformations) {
+            : device_(device), uploadManager_(&uploadManager), size_(data.size()), textureInformations_(textureInformations) {
             
-            createTextureBuffers(commandPool, queue, data);
+            createTextureBuffers(uploadManager, data);
             textureImageView_= Image::createImageView(device_->get(), textureImage_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
             createTextureSampler();
         }
@@ -36,6 +37,8 @@ class Texture {
             size_(std::move(movedTexture.size_)),
             textureInformations_(std::move(movedTexture.textureInformations_)),
             device_(std::move(movedTexture.device_)),
+            uploadManager_(movedTexture.uploadManager_),
+            uploadValue_(movedTexture.uploadValue_),
             textureImage_(std::move(movedTexture.textureImage_)),
             textureImageAllocation_(std::move(movedTexture.textureImageAllocation_)),
             textureImageView_(std::move(movedTexture.textureImageView_)),
@@ -63,6 +66,8 @@ class Texture {
                 textureImageView_ = nullptr;
             }
             if (textureImage_) {
+                //The recorded upload may not be done yet
+                uploadManager_->retire(uploadValue_, textureImage_);
                 vmaDestroyImage(device_->getAllocator(), textureImage_, textureImageAllocation_);
                 textureImageAllocation_ = nullptr;
                 textureImage_ = nullptr;
@@ -71,28 +76,15 @@ class Texture {
 
         }
 
-        void createTextureBuffers(VkCommandPool commandPool, VkQueue queue, std::vector<uint8_t> const& data) {
+        //Note: the upload is only recorded, it is submitted with the next flush of the upload manager
+        void createTextureBuffers(UploadManager& uploadManager, std::vector<uint8_t> const& data) {
             
-            VkBuffer stagingBuffer;
-            VmaAllocation stagingBufferAllocation;
-            VmaAllocationInfo bufferAllocInfo;
-
-            Buffer::create(device_->getAllocator(), size_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, stagingBuffer, stagingBufferAllocation, &bufferAllocInfo);
-
-            memcpy(bufferAllocInfo.pMappedData, data.data(), static_cast<size_t>(size_));
-    
             Buffer::createImage(device_->getAllocator(), textureInformations_.width, textureInformations_.height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 0, textureImage_, textureImageAllocation_); 
 
-            // Change the organisation of the image to optimize the data reception
-            Image::transitionImageLayout(device_->get(), commandPool, queue, textureImage_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-            // Copy the buffer into the image
-            Buffer::copyToImage(device_->get(), commandPool, queue, stagingBuffer, textureImage_, textureInformations_.width, textureInformations_.height);
+            // Transitions and copy are recorded in the current upload batch
+            uploadManager.uploadImage(textureImage_, VK_FORMAT_R8G8B8A8_SRGB, data.data(), size_, textureInformations_.width, textureInformations_.height);
+            uploadValue_ = uploadManager.getUploadValue();
 
-            // Then change again the organisation of the image after the copy to optimize the read in the shader
-            Image::transitionImageLayout(device_->get(), commandPool, queue, textureImage_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-            vmaDestroyBuffer(device_->getAllocator(), stagingBuffer, stagingBufferAllocation);
         }
 
         void createTextureSampler() {
@@ -147,6 +139,10 @@ class Texture {
         
         //Saved vulkan objects
         const Device* device_;
+        UploadManager* uploadManager_;
+
+        //Signaled once the upload of the image is done
+        uint64_t uploadValue_ = 0;
         // VkCommandPool commandPool_;
         // VkQueue queue_;
 
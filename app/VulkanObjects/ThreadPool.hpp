@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+//Fixed number of worker threads running the submitted jobs in submission order
+class ThreadPool {
+
+    public:
+        ThreadPool(uint32_t threadCount = defaultThreadCount()) {
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                threads_.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        //The jobs already submitted are finished first
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            jobAvailable_.notify_all();
+
+            for (std::thread& thread : threads_) {
+                thread.join();
+            }
+        }
+
+        ThreadPool(ThreadPool&&) = delete; //TODO: Declarer un move constructor
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> job) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                jobs_.push_back(std::move(job));
+                ++pendingJobs_;
+            }
+            jobAvailable_.notify_one();
+        }
+
+        //Block until every submitted job is finished
+        void waitIdle() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this]() { return pendingJobs_ == 0; });
+        }
+
+        uint32_t getThreadCount() const {
+            return static_cast<uint32_t>(threads_.size());
+        }
+
+        //Keep one core for the main thread
+        static uint32_t defaultThreadCount() {
+            uint32_t coreCount = std::thread::hardware_concurrency();
+            return coreCount > 1 ? coreCount - 1 : 1;
+        }
+
+    private:
+
+        void workerLoop() {
+            while (true) {
+
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    jobAvailable_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+
+                    if (jobs_.empty()) return;
+
+                    job = std::move(jobs_.front());
+                    jobs_.pop_front();
+                }
+
+                job();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --pendingJobs_;
+                }
+                idle_.notify_all();
+
+            }
+        }
+
+        std::vector<std::thread> threads_;
+
+        std::mutex mutex_;
+        std::condition_variable jobAvailable_;
+        std::condition_variable idle_;
+
+        std::deque<std::function<void()>> jobs_;
+        size_t pendingJobs_ = 0;
+        bool stopping_ = false;
+
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/Helper/Buffer.hpp>
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+//One persistently mapped uniform buffer, split in one region per frame in flight.
+//Each draw pushes its uniforms at the head of the region of the current frame and binds them with a dynamic offset
+//(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC), so a per-draw update is a memcpy and no descriptor update.
+class UniformRing {
+
+    public:
+
+        //Default capacity of the region of each frame
+        static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4 * 1024 * 1024;
+
+        UniformRing(Device const& device, uint16_t framesInFlight, VkDeviceSize frameSize = DEFAULT_FRAME_SIZE) : allocator_(device.getAllocator()), heads_(framesInFlight, 0) {
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device.getPhysical(), &properties);
+            alignment_ = properties.limits.minUniformBufferOffsetAlignment;
+            maxRange_ = properties.limits.maxUniformBufferRange;
+
+            frameSize_ = align(frameSize);
+
+            //Written every frame by the CPU and read by the graphics and the async compute queues, ownership transfers would be needed each frame
+            VmaAllocationInfo allocationInfo;
+            Buffer::create(allocator_, frameSize_ * framesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, buffer_, allocation_, &allocationInfo, device.getGraphicsComputeFamilies());
+
+            mapped_ = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        }
+
+        ~UniformRing() {
+            vmaDestroyBuffer(allocator_, buffer_, allocation_);
+        }
+
+        UniformRing(UniformRing&&) = delete; //TODO: Declarer un move constructor
+        UniformRing& operator=(UniformRing&&) = delete;
+
+        UniformRing(const UniformRing&) = delete;
+        UniformRing& operator=(const UniformRing&) = delete;
+
+        //The GPU must be done with the previous use of this frame
+        void beginFrame(uint32_t frameIndex) {
+            currentFrame_ = frameIndex;
+            heads_[frameIndex] = 0;
+        }
+
+        //Copy data at the head of the current frame. Return the dynamic offset to give when binding
+        uint32_t push(const void* data, VkDeviceSize size) {
+
+            VkDeviceSize& head = heads_[currentFrame_];
+
+            if (size > maxRange_) {
+                throw std::runtime_error("Uniform larger than maxUniformBufferRange !");
+            }
+
+            if (head + size > frameSize_) {
+                throw std::runtime_error("Uniform ring is full, increase its frame size !");
+            }
+
+            VkDeviceSize offset = currentFrame_ * frameSize_ + head;
+            memcpy(mapped_ + offset, data, size);
+
+            //Every dynamic offset must be a multiple of the alignment
+            head = align(head + size);
+
+            return static_cast<uint32_t>(offset);
+        }
+
+        //Make the writes of the frame visible to the GPU (nothing to do on coherent memory)
+        void flush(uint32_t frameIndex) {
+            if (heads_[frameIndex] == 0) return;
+            vmaFlushAllocation(allocator_, allocation_, frameIndex * frameSize_, heads_[frameIndex]);
+        }
+
+        VkBuffer getBuffer() const {
+            return buffer_;
+        }
+
+        VkDeviceSize getFrameSize() const {
+            return frameSize_;
+        }
+
+        //Bytes used by the frame
+        VkDeviceSize getUsedSize(uint32_t frameIndex) const {
+            return heads_[frameIndex];
+        }
+
+    private:
+
+        VkDeviceSize align(VkDeviceSize size) const {
+            return (size + alignment_ - 1) / alignment_ * alignment_;
+        }
+
+        VmaAllocator allocator_;
+
+        VkBuffer buffer_ = VK_NULL_HANDLE;
+        VmaAllocation allocation_ = VK_NULL_HANDLE;
+        uint8_t* mapped_ = nullptr;
+
+        VkDeviceSize alignment_;
+        VkDeviceSize maxRange_;
+        VkDeviceSize frameSize_;
+
+        uint32_t currentFrame_ = 0;
+        std::vector<VkDeviceSize> heads_;
+
+};
@@ -0,0 +1,471 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/CommandPool.hpp>
+#include <VulkanObjects/CommandBuffers.hpp>
+#include <VulkanObjects/GpuTimeline.hpp>
+
+#include <VulkanObjects/Helper/Buffer.hpp>
+#include <VulkanObjects/Helper/Image.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <vector>
+#include <deque>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+//Record many uploads (copies and layout transitions) in one command buffer per batch.
+//The data go through a persistent staging ring buffer, and each batch signal the next value of the upload timeline instead of waiting the queue idle.
+//If the device has a dedicated transfer queue, the batches are submitted on it: the resources are released by the transfer family
+//and must be acquired by the graphics family (recordAcquireBarriers) in a submission waiting the returned semaphores
+//(the upload timeline itself if supported, binary semaphores otherwise).
+class UploadManager {
+
+    public:
+        UploadManager(Device const& device, VkDeviceSize stagingSize = 64 * 1024 * 1024, uint32_t batchCount = 4)
+            : device_(&device), dedicatedQueue_(device.hasDedicatedTransferQueue()), stagingSize_(stagingSize),
+              commandPool_(device, device.getTransferFamily(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT), commandBuffers_(batchCount, device, commandPool_), timeline_(device, device.getTransferQueue()), batches_(batchCount) {
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device.getPhysical(), &properties);
+
+            //Image copies require an offset multiple of 4 and of the texel size
+            alignment_ = std::max<VkDeviceSize>(16, properties.limits.optimalBufferCopyOffsetAlignment);
+
+            initializeStagingBuffer();
+        }
+
+        ~UploadManager() {
+            waitIdle();
+
+            //Note: the graphics submissions waiting them must be finished
+            for (VkSemaphore semaphore : semaphores_) {
+                vkDestroySemaphore(device_->get(), semaphore, nullptr);
+            }
+
+            vmaDestroyBuffer(device_->getAllocator(), stagingBuffer_, stagingBufferAllocation_);
+        }
+
+        UploadManager(UploadManager&&) = delete; //TODO: Declarer un move constructor
+        UploadManager& operator=(UploadManager&&) = delete;
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager& operator=(const UploadManager&) = delete;
+
+        //Copy the data now in the staging memory and record the copy into dstBuffer. The copy is done on the GPU after the next flush.
+        void uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0) {
+
+            if (size == 0) return;
+
+            auto [srcBuffer, srcOffset] = stage(data, size);
+
+            Buffer::recordCopy(getCommandBuffer(), srcBuffer, dstBuffer, size, srcOffset, dstOffset);
+
+            if (dedicatedQueue_) {
+                VkBufferMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcQueueFamilyIndex = device_->getTransferFamily();
+                barrier.dstQueueFamilyIndex = device_->getQueueFamilyIndices().graphicsFamily.value();
+                barrier.buffer = dstBuffer;
+                barrier.offset = dstOffset;
+                barrier.size = size;
+
+                batches_[currentBatch_].bufferBarriers.push_back(barrier);
+            }
+
+        }
+
+        //Same for a whole 2D image, which end in the VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL layout
+        void uploadImage(VkImage image, VkFormat format, const void* data, VkDeviceSize size, uint32_t width, uint32_t height) {
+
+            auto [srcBuffer, srcOffset] = stage(data, size);
+
+            VkCommandBuffer commandBuffer = getCommandBuffer();
+
+            // Change the organisation of the image to optimize the data reception
+            Image::recordTransitionImageLayout(commandBuffer, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+            // Copy the buffer into the image
+            Buffer::recordCopyToImage(commandBuffer, srcBuffer, image, width, height, srcOffset);
+
+            // Then change again the organisation of the image after the copy to optimize the read in the shader
+            if (dedicatedQueue_) {
+                //The transfer queue can't wait the fragment shader stage, the transition is done by the ownership transfer
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                barrier.srcQueueFamilyIndex = device_->getTransferFamily();
+                barrier.dstQueueFamilyIndex = device_->getQueueFamilyIndices().graphicsFamily.value();
+                barrier.image = image;
+                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.baseMipLevel = 0;
+                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.baseArrayLayer = 0;
+                barrier.subresourceRange.layerCount = 1;
+
+                batches_[currentBatch_].imageBarriers.push_back(barrier);
+            }
+            else {
+                Image::recordTransitionImageLayout(commandBuffer, image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+
+        }
+
+        //Submit the recorded uploads. Work submitted after on the same queue will see them.
+        void flush() {
+
+            collect();
+
+            if (!recording_) return;
+
+            Batch& batch = batches_[currentBatch_];
+            VkCommandBuffer commandBuffer = commandBuffers_.get()[currentBatch_];
+
+            std::vector<VkSemaphore> signalSemaphores;
+
+            if (dedicatedQueue_) {
+                //Release the resources to the graphics family, the destination part of the barriers is ignored here
+                for (VkBufferMemoryBarrier& barrier : batch.bufferBarriers) barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                for (VkImageMemoryBarrier& barrier : batch.imageBarriers) barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                    0, nullptr,
+                    static_cast<uint32_t>(batch.bufferBarriers.size()), batch.bufferBarriers.data(),
+                    static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data()
+                );
+
+                //The graphics queue wait the timeline if possible, a binary semaphore otherwise
+                if (!timeline_.usesTimelineSemaphore()) signalSemaphores.push_back(getSemaphore());
+            }
+            else {
+                //Make the transfers visible to every later use of the buffers (images are handled by their layout transition)
+                VkMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = ACQUIRE_ACCESSES;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, ACQUIRE_STAGES, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            }
+
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record upload command buffer !");
+            }
+
+            batch.timelineValue = timeline_.submit({commandBuffer}, {}, signalSemaphores);
+
+            if (dedicatedQueue_) {
+                //The same barriers must now be recorded on the graphics queue to acquire the resources
+                for (VkBufferMemoryBarrier& barrier : batch.bufferBarriers) {
+                    barrier.srcAccessMask = 0;
+                    barrier.dstAccessMask = ACQUIRE_ACCESSES;
+                }
+                for (VkImageMemoryBarrier& barrier : batch.imageBarriers) {
+                    barrier.srcAccessMask = 0;
+                    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                }
+
+                GpuTimeline::Wait wait = timeline_.usesTimelineSemaphore() ? timeline_.waitFor(batch.timelineValue, ACQUIRE_STAGES) : GpuTimeline::Wait{signalSemaphores[0], 0, ACQUIRE_STAGES};
+
+                pendingAcquires_.push_back({wait, std::move(batch.bufferBarriers), std::move(batch.imageBarriers)});
+                batch.bufferBarriers.clear();
+                batch.imageBarriers.clear();
+            }
+
+            batch.stagingEnd = stagingHead_;
+            batch.submitted = true;
+            submittedBatches_.push_back(currentBatch_);
+
+            recording_ = false;
+            currentBatch_ = (currentBatch_ + 1) % batches_.size();
+
+        }
+
+        //Submit and wait all the uploads
+        void waitIdle() {
+            flush();
+
+            while (!submittedBatches_.empty()) {
+                retireOldestBatch();
+            }
+        }
+
+        //Retire the batches finished by the GPU without blocking
+        void collect() {
+            while (!submittedBatches_.empty() && timeline_.isCompleted(batches_[submittedBatches_.front()].timelineValue)) {
+                retireOldestBatch();
+            }
+        }
+
+        bool hasPendingUploads() const {
+            return recording_;
+        }
+
+        //Timeline value that the uploads recorded since the last flush will signal
+        uint64_t getUploadValue() const {
+            return timeline_.getLastSubmittedValue() + (recording_ ? 1 : 0);
+        }
+
+        //Note: with a dedicated transfer queue, the resources must still be acquired by the graphics family
+        bool isUploadComplete(uint64_t uploadValue) {
+            return timeline_.isCompleted(uploadValue);
+        }
+
+        //Before destroying a resource uploaded up to uploadValue (getUploadValue after its uploads): the copies still recorded are submitted
+        //and waited, and its pending acquisition is dropped so no later command targets the destroyed handle
+        void retire(uint64_t uploadValue, VkBuffer buffer) {
+            waitUpload(uploadValue);
+
+            for (PendingAcquire& pendingAcquire : pendingAcquires_) {
+                std::erase_if(pendingAcquire.bufferBarriers, [buffer](VkBufferMemoryBarrier const& barrier) { return barrier.buffer == buffer; });
+            }
+        }
+
+        void retire(uint64_t uploadValue, VkImage image) {
+            waitUpload(uploadValue);
+
+            for (PendingAcquire& pendingAcquire : pendingAcquires_) {
+                std::erase_if(pendingAcquire.imageBarriers, [image](VkImageMemoryBarrier const& barrier) { return barrier.image == image; });
+            }
+        }
+
+        GpuTimeline& getTimeline() {
+            return timeline_;
+        }
+
+        //Dedicated transfer queue only: record in a graphics command buffer (outside a render pass) the acquisition of the flushed uploads.
+        //The submission of this command buffer must wait the semaphores added to waits,
+        //then give them back with recycleSemaphores once it is finished.
+        void recordAcquireBarriers(VkCommandBuffer commandBuffer, std::vector<GpuTimeline::Wait>& waits) {
+
+            for (PendingAcquire& pendingAcquire : pendingAcquires_) {
+
+                vkCmdPipelineBarrier(commandBuffer, ACQUIRE_STAGES, ACQUIRE_STAGES, 0,
+                    0, nullptr,
+                    static_cast<uint32_t>(pendingAcquire.bufferBarriers.size()), pendingAcquire.bufferBarriers.data(),
+                    static_cast<uint32_t>(pendingAcquire.imageBarriers.size()), pendingAcquire.imageBarriers.data()
+                );
+
+                waits.push_back(pendingAcquire.wait);
+
+            }
+
+            pendingAcquires_.clear();
+
+        }
+
+        void recycleSemaphores(std::vector<GpuTimeline::Wait> const& waits) {
+            //The timeline semaphore is not recycled
+            if (timeline_.usesTimelineSemaphore()) return;
+
+            for (GpuTimeline::Wait const& wait : waits) {
+                freeSemaphores_.push_back(wait.semaphore);
+            }
+        }
+
+        //Stages of the graphics queue that may use the uploaded resources, and how
+        static constexpr VkPipelineStageFlags ACQUIRE_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        static constexpr VkAccessFlags ACQUIRE_ACCESSES = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    private:
+
+        struct Batch {
+            uint64_t timelineValue = 0;
+            bool submitted = false;
+
+            //Position of the staging head after this batch, the staging memory before it is free once the batch is done
+            VkDeviceSize stagingEnd = 0;
+
+            //Staging buffers of the uploads too big for the ring
+            std::vector<std::pair<VkBuffer, VmaAllocation>> temporaryBuffers;
+
+            //Queue family ownership transfers of the batch, only with a dedicated transfer queue
+            std::vector<VkBufferMemoryBarrier> bufferBarriers;
+            std::vector<VkImageMemoryBarrier> imageBarriers;
+        };
+
+        //Flushed batch whose resources are not yet acquired by the graphics family
+        struct PendingAcquire {
+            GpuTimeline::Wait wait;
+            std::vector<VkBufferMemoryBarrier> bufferBarriers;
+            std::vector<VkImageMemoryBarrier> imageBarriers;
+        };
+
+        void waitUpload(uint64_t uploadValue) {
+            if (uploadValue > timeline_.getLastSubmittedValue()) flush();
+            timeline_.wait(uploadValue);
+        }
+
+        //Fallback without timeline semaphores: binary semaphores can only be signaled again once their wait is done, so they are recycled by the waiter
+        VkSemaphore getSemaphore() {
+
+            if (!freeSemaphores_.empty()) {
+                VkSemaphore semaphore = freeSemaphores_.back();
+                freeSemaphores_.pop_back();
+                return semaphore;
+            }
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+            VkSemaphore semaphore;
+            if (vkCreateSemaphore(device_->get(), &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create upload semaphore !");
+            }
+
+            semaphores_.push_back(semaphore);
+            return semaphore;
+
+        }
+
+        void initializeStagingBuffer() {
+            VmaAllocationInfo allocationInfo;
+            Buffer::create(device_->getAllocator(), stagingSize_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, stagingBuffer_, stagingBufferAllocation_, &allocationInfo);
+
+            stagingBufferMapped_ = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        }
+
+        //Return the command buffer of the batch being recorded, start a new one if needed
+        VkCommandBuffer getCommandBuffer() {
+
+            if (recording_) return commandBuffers_.get()[currentBatch_];
+
+            //The batches are used in turn, so if this one is still in flight it is the oldest
+            while (batches_[currentBatch_].submitted) {
+                retireOldestBatch();
+            }
+
+            VkCommandBuffer commandBuffer = commandBuffers_.get()[currentBatch_];
+            vkResetCommandBuffer(commandBuffer, 0);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin recording upload command buffer !");
+            }
+
+            recording_ = true;
+            return commandBuffer;
+
+        }
+
+        //Copy the data in staging memory, return the buffer and the offset to copy from
+        std::pair<VkBuffer, VkDeviceSize> stage(const void* data, VkDeviceSize size) {
+
+            //Too big for the ring, use a dedicated staging buffer released with the batch
+            if (size > stagingSize_) {
+
+                VkBuffer buffer;
+                VmaAllocation allocation;
+                VmaAllocationInfo allocationInfo;
+
+                Buffer::create(device_->getAllocator(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, buffer, allocation, &allocationInfo);
+
+                memcpy(allocationInfo.pMappedData, data, static_cast<size_t>(size));
+                vmaFlushAllocation(device_->getAllocator(), allocation, 0, VK_WHOLE_SIZE);
+
+                //Make sure a batch is recording before giving it the buffer
+                getCommandBuffer();
+                batches_[currentBatch_].temporaryBuffers.emplace_back(buffer, allocation);
+
+                return {buffer, 0};
+            }
+
+            VkDeviceSize offset = allocateStaging(size);
+
+            memcpy(stagingBufferMapped_ + offset, data, static_cast<size_t>(size));
+            vmaFlushAllocation(device_->getAllocator(), stagingBufferAllocation_, offset, size);
+
+            return {stagingBuffer_, offset};
+
+        }
+
+        //Head and tail are ever increasing positions, the physical offset is position % stagingSize_
+        VkDeviceSize allocateStaging(VkDeviceSize size) {
+
+            VkDeviceSize position = alignUp(stagingHead_, alignment_);
+
+            //An allocation can't wrap around the end of the ring
+            if (position % stagingSize_ + size > stagingSize_) {
+                position = alignUp(position, stagingSize_);
+            }
+
+            //Free the space by retiring the oldest batches, the current one may have to be submitted first
+            while (position + size - stagingTail_ > stagingSize_) {
+
+                if (submittedBatches_.empty()) {
+                    flush();
+
+                    //The whole ring was used by the current batch, so it is now free
+                    if (submittedBatches_.empty()) break;
+                }
+
+                retireOldestBatch();
+            }
+
+            //Make sure the current batch is recording, it will own this part of the ring
+            getCommandBuffer();
+
+            stagingHead_ = position + size;
+            return position % stagingSize_;
+
+        }
+
+        void retireOldestBatch() {
+
+            Batch& batch = batches_[submittedBatches_.front()];
+
+            timeline_.wait(batch.timelineValue);
+
+            for (auto [buffer, allocation] : batch.temporaryBuffers) {
+                vmaDestroyBuffer(device_->getAllocator(), buffer, allocation);
+            }
+            batch.temporaryBuffers.clear();
+
+            stagingTail_ = std::max(stagingTail_, batch.stagingEnd);
+
+            batch.submitted = false;
+            submittedBatches_.pop_front();
+
+        }
+
+        static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        //Vulkan objects save
+        const Device* device_;
+        bool dedicatedQueue_;
+
+        //Staging ring
+        VkDeviceSize stagingSize_;
+        VkDeviceSize alignment_;
+        VkBuffer stagingBuffer_;
+        VmaAllocation stagingBufferAllocation_;
+        uint8_t* stagingBufferMapped_;
+
+        VkDeviceSize stagingHead_ = 0;
+        VkDeviceSize stagingTail_ = 0;
+
+        //Batches
+        CommandPool commandPool_;
+        CommandBuffers commandBuffers_;
+        GpuTimeline timeline_;
+
+        std::vector<Batch> batches_;
+        std::deque<size_t> submittedBatches_;
+        size_t currentBatch_ = 0;
+        bool recording_ = false;
+
+        //Ownership transfers
+        std::vector<PendingAcquire> pendingAcquires_;
+        std::vector<VkSemaphore> semaphores_;
+        std::vector<VkSemaphore> freeSemaphores_;
+
+};
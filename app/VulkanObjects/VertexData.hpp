@@ -4,6 +4,7 @@
 #include <vulkan/vulkan.h>
 
 #include <VulkanObjects/Device.hpp>
+#include <VulkanObjects/UploadManager.hpp>
 #include <VulkanObjects/Helper/Buffer.hpp>
 
 #include <glm/vec2.hpp>
@@ -15,18 +16,21 @@
 
 struct VertexData {
 
-    VertexData(const Device* device, VkCommandPool commandPool)
-        : device_(device), commandPool_(commandPool) {}
+    VertexData(const Device* device, UploadManager* uploadManager)
+        : device_(device), uploadManager_(uploadManager) {}
 
     ~VertexData() {
         
+        //The recorded uploads may not be done yet
         if (vertexBuffer_) {
+            uploadManager_->retire(uploadValue_, vertexBuffer_);
             vmaDestroyBuffer(device_->getAllocator(), vertexBuffer_, vertexBufferAllocation_);
             vertexBuffer_ = nullptr;
             vertexBufferAllocation_ = nullptr;
         }
 
         if (indexBuffer_) {
+            uploadManager_->retire(uploadValue_, indexBuffer_);
             vmaDestroyBuffer(device_->getAllocator(), indexBuffer_, indexBufferAllocation_);
             indexBuffer_ = nullptr;
             indexBufferAllocation_ = nullptr;
@@ -56,53 +60,25 @@ struct VertexData {
 		vkCmdDrawIndexed(commandBuffer, indicesSize_, 1, 0, 0, 0);
     }
 
+    //Note: the copies are only recorded, they are submitted with the next flush of the upload manager (at the latest by the next beginRecordingDraw)
     VkResult setData(std::vector<float> const& vertices, std::vector<uint32_t> const& indices) {
 
-        void* data;
-
         //// Create vertex buffer
         VkDeviceSize vertexBufferSize = sizeof(float) * vertices.size();
 
-		VkBuffer stagingVertexBuffer;
-		VmaAllocation stagingVertexBufferAllocation;
-		VmaAllocationInfo stagingVertexBufferAllocationInfo;
-
-		Buffer::create(device_->getAllocator(), vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, stagingVertexBuffer, stagingVertexBufferAllocation, &stagingVertexBufferAllocationInfo);
-
-		// vkMapMemory(device_->get(), stagingVertexBufferMemory, 0, vertexBufferSize, 0, &data);
-		memcpy(stagingVertexBufferAllocationInfo.pMappedData, vertices.data(), (size_t) vertexBufferSize);
-		// vkUnmapMemory(device_->get(), stagingVertexBufferMemory);
-
 		Buffer::create(device_->getAllocator(), vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 0, vertexBuffer_, vertexBufferAllocation_, nullptr);
 
-		Buffer::copy(device_->get(), commandPool_, device_->getGraphicsQueue(), stagingVertexBuffer, vertexBuffer_, vertexBufferSize);
-
-		// vkDestroyBuffer(device_->get(), stagingVertexBuffer, nullptr);
-		// vkFreeMemory(device_->get(), stagingVertexBufferMemory, nullptr);
-        vmaDestroyBuffer(device_->getAllocator(), stagingVertexBuffer, stagingVertexBufferAllocation);
+        uploadManager_->uploadBuffer(vertexBuffer_, vertices.data(), vertexBufferSize);
 
         //// Create index buffer
         VkDeviceSize indexBufferSize = sizeof(uint32_t) * indices.size();
 
-        VkBuffer stagingIndexBuffer;
-        VmaAllocation stagingIndexBufferAllocation;
-        VmaAllocationInfo stagingIndexBufferAllocationInfo;
-
-        Buffer::create(device_->getAllocator(), indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, stagingIndexBuffer, stagingIndexBufferAllocation, &stagingIndexBufferAllocationInfo);
-
-        // vkMapMemory(device_->get(), stagingIndexBufferMemory, 0, indexBufferSize, 0, &data);
-        memcpy(stagingIndexBufferAllocationInfo.pMappedData, indices.data(), (size_t) indexBufferSize);
-        // vkUnmapMemory(device_->get(), stagingIndexBufferMemory);
-
         Buffer::create(device_->getAllocator(), indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 0, indexBuffer_, indexBufferAllocation_, nullptr);
 
-        Buffer::copy(device_->get(), commandPool_, device_->getGraphicsQueue(), stagingIndexBuffer, indexBuffer_, indexBufferSize);
-
-        // vkDestroyBuffer(device_->get(), stagingIndexBuffer, nullptr);
-        // vkFreeMemory(device_->get(), stagingIndexBufferMemory, nullptr);
-        vmaDestroyBuffer(device_->getAllocator(), stagingIndexBuffer, stagingIndexBufferAllocation);
+        uploadManager_->uploadBuffer(indexBuffer_, indices.data(), indexBufferSize);
 
         indicesSize_ = indices.size();
+        uploadValue_ = uploadManager_->getUploadValue();
 
         return VK_SUCCESS;
 
@@ -158,7 +134,10 @@ struct VertexData {
 
         //Vulkan objects save
         const Device* device_;
-        VkCommandPool commandPool_;
+        UploadManager* uploadManager_;
+
+        //Signaled once the uploads of the buffers are done
+        uint64_t uploadValue_ = 0;
 
         VkBuffer vertexBuffer_ = nullptr;
         VmaAllocation vertexBufferAllocation_ = nullptr;
@@ -9,10 +9,18 @@
 #include <VulkanObjects/Device.hpp>
 #include <VulkanObjects/Allocator.hpp>
 #include <VulkanObjects/SwapChain.hpp>
+#include <VulkanObjects/OffscreenTarget.hpp>
 #include <VulkanObjects/RenderPass.hpp>
 #include <VulkanObjects/CommandPool.hpp>
 #include <VulkanObjects/CommandBuffers.hpp>
+#include <VulkanObjects/ParallelRecorder.hpp>
 #include <VulkanObjects/SynchronisationObjects.hpp>
+#include <VulkanObjects/DeletionQueue.hpp>
+#include <VulkanObjects/ThreadPool.hpp>
+#include <VulkanObjects/UploadManager.hpp>
+#include <VulkanObjects/AsyncCompute.hpp>
+#include <VulkanObjects/UniformRing.hpp>
+#include <VulkanObjects/Profiler.hpp>
 
 //Debug
 #include <VulkanObjects/DebugMessenger.hpp>
@@ -20,57 +28,138 @@
 
 //Generator
 #include <VulkanObjects/Shader.hpp>
+#include <VulkanObjects/Material.hpp>
+#include <VulkanObjects/MeshArena.hpp>
+#include <VulkanObjects/IndirectDrawBuffer.hpp>
+#include <VulkanObjects/FrustumCuller.hpp>
 #include <VulkanObjects/GraphicsPipeline.hpp>
+#include <VulkanObjects/ComputePipeline.hpp>
+
+#include <list>
+#include <optional>
+#include <algorithm>
+#include <functional>
 
 bool validationDebugLayerActivated = true;
 
 class VulkanWrapper {
 
     public:
+        //Receive the tightly packed RGBA pixels of a headless frame once the GPU finished it
+        using ReadbackCallback = std::function<void(void const* data, VkExtent2D const& extent)>;
+
         VulkanWrapper(GLFWwindow* window, uint16_t framesInFlight, bool depthCheck = false)
-            : framesInFlight_(framesInFlight), depthCheck_(depthCheck), window_(window), instance_(validationDebugLayerActivated), debugMessenger_(instance_, validationDebugLayerActivated), surface_(window_, instance_), device_(instance_, surface_, validationDebugLayerActivated), swapChain_(window, surface_, device_, depthCheck_),
-            renderPass_(device_, swapChain_, depthCheck_), commandPool_(surface_, device_), commandBuffers_(framesInFlight_, device_, commandPool_), syncObjs_(framesInFlight, device_)
+            : framesInFlight_(framesInFlight), depthCheck_(depthCheck), window_(window), instance_(validationDebugLayerActivated), debugMessenger_(instance_, validationDebugLayerActivated), surface_(std::in_place, window_, instance_), device_(instance_, *surface_, validationDebugLayerActivated), swapChain_(std::in_place, window, *surface_, device_, depthCheck_),
+            renderPass_(device_, *swapChain_, depthCheck_), layoutCache_(device_), shaderModuleCache_(device_), pipelineStateCache_(device_), commandPool_(device_), commandBuffers_(framesInFlight_, device_, commandPool_), parallelRecorder_(device_, framesInFlight_), syncObjs_(framesInFlight, device_), uploadManager_(device_), uploadWaits_(framesInFlight), asyncCompute_(device_, syncObjs_.frameTimeline, framesInFlight), uniformRing_(device_, framesInFlight), descriptorAllocator_(device_, framesInFlight), profiler_(device_, framesInFlight)
         {
 
-            swapChain_.initializeFramebuffers(renderPass_);
+            swapChain_->initializeFramebuffers(renderPass_);
+
+            if (device_.supportsDescriptorIndexing()) bindlessTextures_.emplace(device_, layoutCache_);
         }
 
-        //If true, recording started
-        //If false, failed  to start drawing
-        VkCommandBuffer beginRecordingDraw() {
+        //Headless mode: no window, surface nor swap chain, we draw in offscreen images (one per frame in flight) that can be read back
+        VulkanWrapper(VkExtent2D const& extent, uint16_t framesInFlight, bool depthCheck = false)
+            : framesInFlight_(framesInFlight), depthCheck_(depthCheck), headless_(true), window_(nullptr), instance_(validationDebugLayerActivated, true), debugMessenger_(instance_, validationDebugLayerActivated), device_(instance_, validationDebugLayerActivated), offscreenTarget_(std::in_place, device_, extent, framesInFlight, depthCheck_),
+            renderPass_(device_, *offscreenTarget_, depthCheck_), layoutCache_(device_), shaderModuleCache_(device_), pipelineStateCache_(device_), commandPool_(device_), commandBuffers_(framesInFlight_, device_, commandPool_), parallelRecorder_(device_, framesInFlight_), syncObjs_(framesInFlight, device_), uploadManager_(device_), uploadWaits_(framesInFlight), asyncCompute_(device_, syncObjs_.frameTimeline, framesInFlight), uniformRing_(device_, framesInFlight), descriptorAllocator_(device_, framesInFlight), profiler_(device_, framesInFlight), readbackCallbacks_(framesInFlight)
+        {
 
-            //We wait the fence to be signaled...
-            vkWaitForFences(device_.get(), 1, &syncObjs_.inFlightFences[currentFrame_], VK_TRUE, UINT64_MAX);
+            offscreenTarget_->initializeFramebuffers(renderPass_);
 
-            VkResult result = vkAcquireNextImageKHR(device_.get(), swapChain_.get(), UINT64_MAX, syncObjs_.imageAvailableSemaphores[currentFrame_], VK_NULL_HANDLE, &currentDrawingTargetImageIndex_);
+            if (device_.supportsDescriptorIndexing()) bindlessTextures_.emplace(device_, layoutCache_);
+        }
 
-            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-                recreateGraphicWindow();
-                return nullptr;
-            } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-                throw std::runtime_error("failed to acquire swap chain image!");
-            }
+        //Members are destroyed after the body, once the GPU is idle
+        ~VulkanWrapper() {
+            vkDeviceWaitIdle(device_.get());
+        }
 
-            //...Then we set it to the un-signaled state. Note: we un-signal it only if we're sure that we will submit work with it
-            vkResetFences(device_.get(), 1, &syncObjs_.inFlightFences[currentFrame_]);
-            
-            //TODO DE ICI
-            
-            //TODO: Voir l'ordre ?
-            //TODO: LE DEPLACER
-            // updateUniformBuffer(currentFrame_);
+        VulkanWrapper(VulkanWrapper&&) = delete; //TODO: Declarer un move constructor
+        VulkanWrapper& operator=(VulkanWrapper&&) = delete;
+
+        VulkanWrapper(const VulkanWrapper&) = delete;
+        VulkanWrapper& operator=(const VulkanWrapper&) = delete;
+
+        //Compute work of the frame on the async compute queue (see AsyncCompute), to record before the draws of the frame.
+        //It overlaps the rasterization of the previous frame, the draws only wait the buffers it released to graphics.
+        //nullptr if the frame must be skipped
+        VkCommandBuffer beginRecordingCompute() {
+
+            if (!recordingFrame_ && !prepareFrame()) return nullptr;
+
+            return asyncCompute_.begin(currentFrame_);
+
+        }
+
+        void endRecordingCompute() {
+
+            //The uniforms pushed by the compute work of this frame
+            uniformRing_.flush(currentFrame_);
+
+            asyncCompute_.submit();
+
+        }
+
+        //If true, recording started
+        //If false, failed  to start drawing
+        //recordBeforeRenderPass: record work needing to be outside of the render pass (compute, copies), before the draws of the frame
+        VkCommandBuffer beginRecordingDraw(std::function<void(VkCommandBuffer)> const& recordBeforeRenderPass = {}) {
+
+            //The frame may already be prepared by beginRecordingCompute
+            if (!recordingFrame_ && !prepareFrame()) return nullptr;
 
             //Selected command buffer to store the draw calls
             VkCommandBuffer commandBuffer = commandBuffers_.get()[currentFrame_];
 
             //We now reset and start recording the command buffer
             vkResetCommandBuffer(commandBuffer, 0);
-            beginRecordingCommandBuffer(commandBuffer);
+            beginRecordingCommandBuffer(commandBuffer, VK_SUBPASS_CONTENTS_INLINE, recordBeforeRenderPass);
+
+            return commandBuffer;
+
+        }
+
+        //Multithreaded recording: the render pass only executes the secondary command buffers of the workers (see beginWorkerCommandBuffer).
+        //The draws are recorded in the secondary command buffers, then endRecordingDraw join them once all workers are done.
+        bool beginRecordingParallelDraw(uint32_t workerCount, std::function<void(VkCommandBuffer)> const& recordBeforeRenderPass = {}) {
+
+            if (!recordingFrame_ && !prepareFrame()) return false;
+
+            parallelRecorder_.beginFrame(currentFrame_, workerCount);
+            profiler_.beginWorkers(currentFrame_, workerCount);
+
+            VkCommandBuffer commandBuffer = commandBuffers_.get()[currentFrame_];
+
+            vkResetCommandBuffer(commandBuffer, 0);
+            beginRecordingCommandBuffer(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, recordBeforeRenderPass);
+
+            return true;
+
+        }
+
+        //Can be called from the worker threads, each worker must use its own index (lower than the workerCount of beginRecordingParallelDraw).
+        //A worker can record several command buffers per frame, they are executed in the worker order then in their recording order.
+        VkCommandBuffer beginWorkerCommandBuffer(uint32_t workerIndex) {
+
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.renderPass = renderPass_.get();
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = getFramebuffers()[currentDrawingTargetImageIndex_];
+
+            VkCommandBuffer commandBuffer = parallelRecorder_.begin(workerIndex, inheritanceInfo);
+
+            //Dynamic states are not inherited from the primary command buffer
+            recordDynamicStates(commandBuffer);
 
             return commandBuffer;
 
         }
 
+        void endWorkerCommandBuffer(VkCommandBuffer commandBuffer) {
+            parallelRecorder_.end(commandBuffer);
+        }
+
         void endRecordingDraw() {
 
             //Current command buffer
@@ -78,42 +167,54 @@ class VulkanWrapper {
 
             endRecordingCommandBuffer(commandBuffer);
 
-            VkSubmitInfo submitInfo{};
-            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            //Wait the swap chain image (if any), the uploads and the compute buffers acquired by this frame
+            std::vector<GpuTimeline::Wait> waits = uploadWaits_[currentFrame_];
+            waits.insert(waits.end(), computeWaits_.begin(), computeWaits_.end());
+            computeWaits_.clear();
 
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &commandBuffer;
+            if (!headless_) {
+                waits.push_back({syncObjs_.imageAvailableSemaphores[currentFrame_], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT});
+            }
+
+            //Nothing to present, the frame value is enough to know when the frame is done
+            std::vector<VkSemaphore> signalSemaphores;
+            if (!headless_) signalSemaphores.push_back(syncObjs_.renderFinishedSemaphores[currentFrame_]);
 
-            VkSemaphore waitSemaphores[] = {syncObjs_.imageAvailableSemaphores[currentFrame_]};
-            VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+            //The uniforms pushed by the draws of this frame
+            uniformRing_.flush(currentFrame_);
 
-            submitInfo.waitSemaphoreCount = 1;
-            submitInfo.pWaitSemaphores = waitSemaphores;
-            submitInfo.pWaitDstStageMask = waitStages;
+            Profiler::TimePoint submitStart = Profiler::now();
+            syncObjs_.frameValues[currentFrame_] = syncObjs_.frameTimeline.submit({commandBuffer}, waits, signalSemaphores);
+            profiler_.endCpuPhase(currentFrame_, Profiler::Submit, submitStart);
 
-            VkSemaphore signalSemaphores[] = {syncObjs_.renderFinishedSemaphores[currentFrame_]};
-            submitInfo.signalSemaphoreCount = 1;
-            submitInfo.pSignalSemaphores = signalSemaphores;
+            recordingFrame_ = false;
 
-            if (vkQueueSubmit(device_.getGraphicsQueue(), 1, &submitInfo, syncObjs_.inFlightFences[currentFrame_]) != VK_SUCCESS) {
-                throw std::runtime_error("failed to submit draw command buffer !");
+            if (headless_) {
+                profiler_.endFrame(currentFrame_);
+
+                currentFrame_ = (currentFrame_ + 1) % framesInFlight_;
+                return;
             }
 
             VkPresentInfoKHR presentInfo{};
             presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
             presentInfo.waitSemaphoreCount = 1;
-            presentInfo.pWaitSemaphores = signalSemaphores;
+            presentInfo.pWaitSemaphores = signalSemaphores.data();
 
 
-            VkSwapchainKHR swapChains[] = {swapChain_.get()};
+            VkSwapchainKHR swapChains[] = {swapChain_->get()};
             presentInfo.swapchainCount = 1;
             presentInfo.pSwapchains = swapChains;
             presentInfo.pImageIndices = &currentDrawingTargetImageIndex_;
 
             presentInfo.pResults = nullptr; // Optionnel
 
+            Profiler::TimePoint presentStart = Profiler::now();
             VkResult result = vkQueuePresentKHR(device_.getPresentQueue(), &presentInfo);
+            profiler_.endCpuPhase(currentFrame_, Profiler::Present, presentStart);
+            profiler_.endFrame(currentFrame_);
+
             if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized_) {
                 framebufferResized_ = false;
                 recreateGraphicWindow();
@@ -126,8 +227,10 @@ class VulkanWrapper {
 
         }
         
-        void beginRecordingCommandBuffer(VkCommandBuffer commandBuffer) {
-            
+        void beginRecordingCommandBuffer(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE, std::function<void(VkCommandBuffer)> const& recordBeforeRenderPass = {}) {
+
+            recordingStart_ = Profiler::now();
+
             VkCommandBufferBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
             beginInfo.flags = 0; // Optional
@@ -137,13 +240,24 @@ class VulkanWrapper {
                 throw std::runtime_error("failed to begin recording command buffer!");
             }
 
+            //With a dedicated transfer queue, the flushed uploads must be acquired before the render pass
+            uploadManager_.recordAcquireBarriers(commandBuffer, uploadWaits_[currentFrame_]);
+
+            //Then the buffers exchanged with the async compute queue, the uploaded ones can be given to it
+            asyncCompute_.recordGraphicsBarriers(commandBuffer, computeWaits_);
+
+            //Reset the queries of the frame, must be done outside of the render pass
+            profiler_.recordFrameStart(commandBuffer, currentFrame_);
+
+            if (recordBeforeRenderPass) recordBeforeRenderPass(commandBuffer);
+
             VkRenderPassBeginInfo renderPassInfo{};
             renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
             renderPassInfo.renderPass = renderPass_.get();
-            renderPassInfo.framebuffer = swapChain_.getFramebuffers()[currentDrawingTargetImageIndex_];
+            renderPassInfo.framebuffer = getFramebuffers()[currentDrawingTargetImageIndex_];
 
             renderPassInfo.renderArea.offset = {0, 0};
-            renderPassInfo.renderArea.extent = swapChain_.getExtent();
+            renderPassInfo.renderArea.extent = getExtent();
 
             std::vector<VkClearValue> clearValues(1 + depthCheck_);
             clearValues[0] = {{0.5f, 0.5f, 0.5f, 1.0f}};
@@ -152,35 +266,86 @@ class VulkanWrapper {
             renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
             renderPassInfo.pClearValues = clearValues.data();
 
-            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+            subpassContents_ = contents;
+
+            //The secondary command buffers set their own dynamic states
+            if (contents == VK_SUBPASS_CONTENTS_INLINE) recordDynamicStates(commandBuffer);
+
+        }
+
+        void recordDynamicStates(VkCommandBuffer commandBuffer) {
 
             //ONLY if dynamic viewport and scissor activated during fixed pipeline's function specification
             VkViewport viewport{};
             viewport.x = 0.0f;
             viewport.y = 0.0f;
-            viewport.width = static_cast<float>(swapChain_.getExtent().width);
-            viewport.height = static_cast<float>(swapChain_.getExtent().height);
+            viewport.width = static_cast<float>(getExtent().width);
+            viewport.height = static_cast<float>(getExtent().height);
             viewport.minDepth = 0.0f;
             viewport.maxDepth = 1.0f;
             vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
             
-            // VkRect2D scissor{};
-            // scissor.offset = {0, 0};
-            // scissor.extent = swapChainExtent;
-            // vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            VkRect2D scissor{};
+            scissor.offset = {0, 0};
+            scissor.extent = getExtent();
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
         }
 
         void endRecordingCommandBuffer(VkCommandBuffer commandBuffer) {
+
+            //Join the work of the recording threads
+            if (subpassContents_ == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+                parallelRecorder_.recordExecute(commandBuffer);
+            }
+
             vkCmdEndRenderPass(commandBuffer);
 
+            profiler_.recordFrameEnd(commandBuffer, currentFrame_);
+
+            //Copy the offscreen image after the render pass, the host will get it when the frame value is completed
+            if (headless_ && readbackCallbacks_[currentFrame_]) {
+                offscreenTarget_->recordReadback(commandBuffer, currentDrawingTargetImageIndex_);
+            }
+
             if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
                 throw std::runtime_error("failed to record command buffer !");
             }
+
+            profiler_.endCpuPhase(currentFrame_, Profiler::Recording, recordingStart_);
         }
 
         VkExtent2D const& getExtent() const {
-            return swapChain_.getExtent();
+            return headless_ ? offscreenTarget_->getExtent() : swapChain_->getExtent();
+        }
+
+        bool isHeadless() const {
+            return headless_;
+        }
+
+        //Headless only: to be called between beginRecordingDraw and endRecordingDraw.
+        //The callback is called asynchronously, from pollReadbacks, waitIdle or the next beginRecordingDraw of the same frame, once the GPU finished the frame.
+        void requestReadback(ReadbackCallback callback) {
+            if (!headless_) {
+                throw std::runtime_error("Readback is only available in headless mode !");
+            }
+
+            readbackCallbacks_[currentFrame_] = std::move(callback);
+        }
+
+        //Headless only: deliver the readbacks of the frames already finished by the GPU, without blocking
+        void pollReadbacks() {
+            if (!headless_) return;
+
+            for (uint32_t frameIndex = 0; frameIndex < framesInFlight_; ++frameIndex) {
+                //The value of a frame being recorded is the one of its previous submission, don't deliver its readback too early
+                if (recordingFrame_ && frameIndex == currentFrame_) continue;
+
+                if (readbackCallbacks_[frameIndex] && syncObjs_.frameTimeline.isCompleted(syncObjs_.frameValues[frameIndex])) {
+                    deliverReadback(frameIndex);
+                }
+            }
         }
 
         uint32_t getCurrentFrame() const {
@@ -188,24 +353,208 @@ class VulkanWrapper {
         }
 
         // Generator
-        Shader generateShader(const std::string& vertexFilename, const std::string& fragmentFilename) const {
-            return Shader(&device_, framesInFlight_, vertexFilename, fragmentFilename);
+        Shader generateShader(const std::string& vertexFilename, const std::string& fragmentFilename) {
+            return Shader(&device_, &descriptorAllocator_, &layoutCache_, framesInFlight_, vertexFilename, fragmentFilename);
+        }
+
+        //The shader must have material bindings and its bindings and sets generated
+        Material generateMaterial(Shader const& shader) {
+            return Material(&device_, &descriptorAllocator_, shader, framesInFlight_);
+        }
+
+        Shader generateComputeShader(const std::string& computeFilename) {
+            return Shader(&device_, &descriptorAllocator_, &layoutCache_, framesInFlight_, computeFilename);
+        }
+
+        //The shader must have its bindings and sets generated. The GPU must be done with the pipeline before its destruction
+        ComputePipeline generateComputePipeline(Shader const& shader, SpecializationConstants const& specialization = {}) {
+            return ComputePipeline(device_, shaderModuleCache_, shader, specialization);
+        }
+
+        //Descriptor sets shared by all the shaders, the transient ones live until the end of the current frame
+        DescriptorAllocator& getDescriptorAllocator() {
+            return descriptorAllocator_;
+        }
+
+        //Fixed states matching the render pass: depth test and write when the depth is checked
+        PipelineFixedState getDefaultFixedState() const {
+            PipelineFixedState fixedState;
+            fixedState.depthTest = depthCheck_;
+            fixedState.depthWrite = depthCheck_;
+            return fixedState;
+        }
+
+        //The pipeline is owned by the wrapper, the reference stay valid until destroyGraphicsPipeline
+        GraphicsPipeline& generateGraphicsPipeline(Shader const& shader, std::vector<uint32_t> const& vertexAttributesSize) {
+            return generateGraphicsPipeline(shader, vertexAttributesSize, getDefaultFixedState());
+        }
+
+        //One pipeline variant per set of specialization constants, the same values share the same VkPipeline
+        GraphicsPipeline& generateGraphicsPipeline(Shader const& shader, std::vector<uint32_t> const& vertexAttributesSize, PipelineFixedState const& fixedState, PipelineSpecialization const& specialization = {}) {
+            return graphicsPipelines_.emplace_back(device_, shaderModuleCache_, pipelineStateCache_, shader, renderPass_, vertexAttributesSize, fixedState, specialization);
+        }
+
+        struct GraphicsPipelineInformations {
+            Shader const* shader;
+            std::vector<uint32_t> vertexAttributesSize;
+
+            //The default fixed states if empty
+            std::optional<PipelineFixedState> fixedState;
+            PipelineSpecialization specialization;
+        };
+
+        //Build the pipelines on the worker threads, the vkCreateGraphicsPipelines calls run in parallel.
+        //The returned pipelines can be bound right away: fallback until they are ready (or wait their build if there is no fallback).
+        //The shaders must stay alive until the pipelines are ready.
+        std::vector<GraphicsPipeline*> generateGraphicsPipelinesAsync(std::vector<GraphicsPipelineInformations> const& pipelinesInformations, GraphicsPipeline const* fallback = nullptr) {
+
+            std::vector<GraphicsPipeline*> pipelines;
+            pipelines.reserve(pipelinesInformations.size());
+
+            for (GraphicsPipelineInformations const& informations : pipelinesInformations) {
+                PipelineFixedState fixedState = informations.fixedState.value_or(getDefaultFixedState());
+                GraphicsPipeline& pipeline = graphicsPipelines_.emplace_back(device_, shaderModuleCache_, pipelineStateCache_, *informations.shader, informations.vertexAttributesSize, fixedState, informations.specialization, fallback);
+                pipelines.push_back(&pipeline);
+
+                //The render pass is only replaced after waiting the pool
+                pipelineBuilder_.submit([&pipeline, renderPass = &renderPass_]() {
+                    try {
+                        pipeline.initialize(*renderPass);
+                    } catch (...) {
+                        pipeline.setBuildError(std::current_exception());
+                    }
+                });
+            }
+
+            return pipelines;
+
         }
 
-        GraphicsPipeline generateGraphicsPipeline(Shader const& shader, std::vector<uint32_t> const& vertexAttributesSize) const {
-            return GraphicsPipeline(device_, shader, swapChain_.getExtent(), renderPass_, vertexAttributesSize, depthCheck_);
+        //Block until all the asynchronous pipelines are built
+        void waitPipelineBuilds() {
+            pipelineBuilder_.waitIdle();
         }
 
-        VertexData generateVertexData() const {
-            return VertexData(&device_, commandPool_.get());
+        //The frames in flight may still use it, the Vulkan pipeline is destroyed once they are finished
+        void destroyGraphicsPipeline(GraphicsPipeline& pipeline) {
+
+            //It may still be building
+            pipelineBuilder_.waitIdle();
+
+            auto it = std::find_if(graphicsPipelines_.begin(), graphicsPipelines_.end(), [&pipeline](GraphicsPipeline const& registered) { return &registered == &pipeline; });
+
+            if (it == graphicsPipelines_.end()) {
+                throw std::runtime_error("Graphics pipeline not generated by this wrapper !");
+            }
+
+            //Still shared with other pipelines, nothing to destroy
+            VkPipeline oldPipeline = it->release();
+            if (oldPipeline) {
+                deletionQueue_.push(syncObjs_.frameTimeline.getLastSubmittedValue(), [device = device_.get(), oldPipeline]() { vkDestroyPipeline(device, oldPipeline, nullptr); });
+            }
+
+            graphicsPipelines_.erase(it);
+
+        }
+
+        VertexData generateVertexData() {
+            return VertexData(&device_, &uploadManager_);
+        }
+
+        //One vertex and one index buffer shared by many meshes, drawn after a single bind
+        MeshArena generateMeshArena(std::vector<uint32_t> const& attributesSize, uint32_t vertexCapacity, uint32_t indexCapacity) {
+            return MeshArena(&device_, &uploadManager_, &syncObjs_.frameTimeline, attributesSize, vertexCapacity, indexCapacity);
+        }
+
+        //Freed once the frames already submitted are finished, the arena keeps the pending frees so it can be destroyed first
+        void freeMesh(MeshArena& meshArena, MeshArena::Mesh const& mesh) {
+            meshArena.free(mesh);
+        }
+
+        //Indexed indirect commands of the meshes of an arena, one region per frame in flight.
+        //gpuWritten for the commands written by a compute shader (generateFrustumCuller)
+        IndirectDrawBuffer generateIndirectDrawBuffer(uint32_t maxDraws, bool gpuWritten = false) {
+            return IndirectDrawBuffer(device_, framesInFlight_, maxDraws, gpuWritten);
+        }
+
+        //The compute shader is Shaders/cull.comp, its draws are written in indirectDrawBuffer (gpuWritten, must outlive the culler).
+        //With asyncCompute, the culling is recorded in the command buffer of beginRecordingCompute
+        FrustumCuller generateFrustumCuller(IndirectDrawBuffer const& indirectDrawBuffer, std::string const& shaderFilename = "Shaders/cull.comp.spv", bool asyncCompute = false) {
+            return FrustumCuller(device_, shaderModuleCache_, layoutCache_, descriptorAllocator_, uploadManager_, uniformRing_, indirectDrawBuffer, framesInFlight_, shaderFilename, asyncCompute ? &asyncCompute_ : nullptr);
+        }
+
+        Texture generateTexture(std::vector<uint8_t> const& textureData, Texture::TextureInformations const& textureInformations) {
+            return Texture(&device_, uploadManager_, textureData, textureInformations);
+        }
+
+        //// Bindless textures (descriptor indexing required)
+
+        bool supportsBindlessTextures() const {
+            return bindlessTextures_.has_value();
+        }
+
+        BindlessTextures& getBindlessTextures() {
+            if (!bindlessTextures_) {
+                throw std::runtime_error("Bindless textures are not supported by the device !");
+            }
+            return *bindlessTextures_;
         }
 
-        Texture generateTexture(std::vector<uint8_t> const& textureData, Texture::TextureInformations const& textureInformations) const {
-            return Texture(&device_, commandPool_.get(), device_.getGraphicsQueue(), textureData, textureInformations);
+        //Return the index of the texture in the bindless array
+        uint32_t registerBindlessTexture(Texture const& texture) {
+            return getBindlessTextures().registerTexture(texture);
         }
 
-        void waitIdle() const {
+        //The handle is reused once the frames in flight are finished, the texture can be destroyed after that
+        void releaseBindlessTexture(uint32_t handle) {
+            deletionQueue_.push(syncObjs_.frameTimeline.getLastSubmittedValue(), [bindlessTextures = &getBindlessTextures(), handle]() { bindlessTextures->releaseTexture(handle); });
+        }
+
+        //Once per frame and per bind point (graphics or compute, from the shader): stays bound for all the shaders using the bindless textures with the same push constants
+        void bindBindlessTextures(VkCommandBuffer commandBuffer, Shader const& shader) const {
+            bindlessTextures_->bind(commandBuffer, shader.getPipelineLayout(), shader.getBindPoint());
+        }
+
+        UploadManager& getUploadManager() {
+            return uploadManager_;
+        }
+
+        AsyncCompute& getAsyncCompute() {
+            return asyncCompute_;
+        }
+
+        //Per draw uniforms of the current frame
+        UniformRing& getUniformRing() {
+            return uniformRing_;
+        }
+
+        //Hits and misses of the pipeline deduplication
+        PipelineStateCache::Statistics getPipelineStatistics() const {
+            return pipelineStateCache_.getStatistics();
+        }
+
+        //Profiling
+        Profiler& getProfiler() {
+            return profiler_;
+        }
+
+        //GPU timed scope in the command buffer of the current frame, name must be a string literal.
+        //In a worker command buffer, workerIndex must be the index given to beginWorkerCommandBuffer
+        void beginProfileScope(VkCommandBuffer commandBuffer, const char* name, uint32_t workerIndex = Profiler::FRAME_THREAD) {
+            profiler_.beginScope(commandBuffer, currentFrame_, name, workerIndex);
+        }
+
+        void endProfileScope(VkCommandBuffer commandBuffer, uint32_t workerIndex = Profiler::FRAME_THREAD) {
+            profiler_.endScope(commandBuffer, currentFrame_, workerIndex);
+        }
+
+        void waitIdle() {
+            pipelineBuilder_.waitIdle();
+            uploadManager_.waitIdle();
+            asyncCompute_.waitIdle();
             vkDeviceWaitIdle(device_.get());
+            deletionQueue_.flush();
+            pollReadbacks();
         }
 
         VmaTotalStatistics getMemoryStatistics() {
@@ -219,12 +568,11 @@ class VulkanWrapper {
             framebufferResized_ = true;
         }
 
-        void saveGraphicPipeline(GraphicsPipeline* pipeline) {
-            savedPipeline_ = pipeline;
-        }
-
         void recreateGraphicWindow() {
 
+            //The offscreen target has a fixed extent
+            if (headless_) return;
+
             int width = 0, height = 0;
             glfwGetFramebufferSize(window_, &width, &height);
             while (width == 0 || height == 0) {
@@ -233,34 +581,132 @@ class VulkanWrapper {
                 glfwWaitEvents();
             }
 
-            vkDeviceWaitIdle(device_.get());
-            
-            renderPass_.clean();
-            swapChain_.clean();
-            
-            swapChain_.initializeSwapChain(window_, surface_, device_);
-            swapChain_.initializeImageViews();
-            if (depthCheck_) swapChain_.initializeDepthResources(device_);
+            //No device idle: the frames already submitted keep using the old objects, they are destroyed once these frames are finished
+            //Note: Vulkan can't tell when the presentation engine is done, the end of the frame rendering is used instead
+            uint64_t retireValue = syncObjs_.frameTimeline.getLastSubmittedValue();
+
+            VkFormat oldFormat = swapChain_->getFormat();
+
+            swapChain_->recreate(window_, *surface_, device_, deletionQueue_, retireValue);
 
-            renderPass_.initializeRenderPass(swapChain_, depthCheck_);
+            //The render pass only depends on the formats, keep it if they did not change
+            bool renderPassChanged = swapChain_->getFormat() != oldFormat;
+            if (renderPassChanged) {
+                //The asynchronous builds read the render pass, it can't be replaced while they run
+                pipelineBuilder_.waitIdle();
 
-            swapChain_.initializeFramebuffers(renderPass_);
+                VkRenderPass oldRenderPass = renderPass_.release();
+                deletionQueue_.push(retireValue, [device = device_.get(), oldRenderPass]() { vkDestroyRenderPass(device, oldRenderPass, nullptr); });
 
-            if (savedPipeline_) {
+                renderPass_.initializeRenderPass(*swapChain_, depthCheck_);
+            }
+
+            swapChain_->initializeFramebuffers(renderPass_);
+
+            //Viewport and scissor are dynamic: the pipelines only need to be rebuilt for a new render pass
+            if (renderPassChanged) {
+                for (GraphicsPipeline& pipeline : graphicsPipelines_) {
+
+                    VkPipeline oldPipeline = pipeline.release();
+                    if (oldPipeline) {
+                        deletionQueue_.push(retireValue, [device = device_.get(), oldPipeline]() { vkDestroyPipeline(device, oldPipeline, nullptr); });
+                    }
 
-                savedPipeline_->clean();
-                savedPipeline_->initialize(swapChain_.getExtent(), renderPass_);
+                    pipeline.initialize(renderPass_);
 
+                }
             }
 
         }
 
     private:
+
+        //Wait the frame, acquire its image and flush the uploads. False if the frame must be skipped
+        bool prepareFrame() {
+
+            //We wait the previous submission of this frame to be finished
+            Profiler::TimePoint fenceWaitStart = Profiler::now();
+            syncObjs_.frameTimeline.wait(syncObjs_.frameValues[currentFrame_]);
+
+            //And its compute work, which may not have released anything to the graphics queue
+            asyncCompute_.waitFrame(currentFrame_);
+
+            //Destroy the objects retired by the finished frames
+            if (!deletionQueue_.empty()) deletionQueue_.collect(syncObjs_.frameTimeline.getCompletedValue());
+
+            //The uniforms and transient descriptor sets of the previous frame of this slot are not read anymore
+            uniformRing_.beginFrame(currentFrame_);
+            descriptorAllocator_.resetFrame(currentFrame_);
+
+            //The previous frame of this slot is done, its timestamps can be read
+            profiler_.beginFrame(currentFrame_);
+            profiler_.endCpuPhase(currentFrame_, Profiler::FenceWait, fenceWaitStart);
+
+            //The waits of the upload semaphores of this frame are done
+            uploadManager_.recycleSemaphores(uploadWaits_[currentFrame_]);
+            uploadWaits_[currentFrame_].clear();
+
+            if (headless_) {
+                //The previous content of this frame is done, deliver it before drawing over it
+                deliverReadback(currentFrame_);
+
+                //Each frame in flight has its own offscreen image
+                currentDrawingTargetImageIndex_ = currentFrame_;
+            }
+            else {
+
+                Profiler::TimePoint acquireStart = Profiler::now();
+                VkResult result = vkAcquireNextImageKHR(device_.get(), swapChain_->get(), UINT64_MAX, syncObjs_.imageAvailableSemaphores[currentFrame_], VK_NULL_HANDLE, &currentDrawingTargetImageIndex_);
+                profiler_.endCpuPhase(currentFrame_, Profiler::Acquire, acquireStart);
+
+                if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                    recreateGraphicWindow();
+                    return false;
+                } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+                    throw std::runtime_error("failed to acquire swap chain image!");
+                }
+
+            }
+
+            //Note: nothing to reset, the next submission of this frame signals a new value
+            recordingFrame_ = true;
+
+            //Submit the uploads recorded since the last frame, this frame will wait them (queue order or acquire semaphores)
+            uploadManager_.flush();
+            
+            //TODO DE ICI
+            
+            //TODO: Voir l'ordre ?
+            //TODO: LE DEPLACER
+            // updateUniformBuffer(currentFrame_);
+
+            return true;
+
+        }
+
+        std::vector<VkFramebuffer> const& getFramebuffers() const {
+            return headless_ ? offscreenTarget_->getFramebuffers() : swapChain_->getFramebuffers();
+        }
+
+        //The frame value must be completed
+        void deliverReadback(uint32_t frameIndex) {
+            if (!readbackCallbacks_[frameIndex]) return;
+
+            //Move it out first, the callback may request a new readback
+            ReadbackCallback callback = std::move(readbackCallbacks_[frameIndex]);
+            readbackCallbacks_[frameIndex] = nullptr;
+
+            callback(offscreenTarget_->getReadbackData(frameIndex), offscreenTarget_->getExtent());
+        }
+
         //Variables
         uint16_t framesInFlight_;
         bool depthCheck_;
 
+        bool headless_ = false;
+
         bool framebufferResized_ = false;
+        bool recordingFrame_ = false;
         uint32_t currentFrame_ = 0;
         uint32_t currentDrawingTargetImageIndex_;
 
@@ -270,20 +716,69 @@ class VulkanWrapper {
         //Vulkan
         Instance instance_;
         DebugMessenger debugMessenger_;
-        Surface surface_;
+        std::optional<Surface> surface_;
 
         Device device_;
 
-        SwapChain swapChain_;
+        //Either the swap chain (window) or the offscreen target (headless) is used
+        std::optional<SwapChain> swapChain_;
+        std::optional<OffscreenTarget> offscreenTarget_;
 
         RenderPass renderPass_;
 
+        //Layouts shared by the shaders, must outlive them and the pipelines
+        LayoutCache layoutCache_;
+
+        //Textures array of the shaders using descriptor indexing, empty if not supported
+        std::optional<BindlessTextures> bindlessTextures_;
+
+        //SPIR-V and shader modules shared by the pipelines
+        ShaderModuleCache shaderModuleCache_;
+
+        //The VkPipelines shared between the GraphicsPipelines, must outlive them
+        PipelineStateCache pipelineStateCache_;
+
+        //Registry of the pipelines, a list to keep the references valid
+        std::list<GraphicsPipeline> graphicsPipelines_;
+
+        //Asynchronous pipeline builds, destroyed (joined) before the pipelines
+        ThreadPool pipelineBuilder_;
+
         CommandPool commandPool_;
         CommandBuffers commandBuffers_;
 
+        //Per worker thread and per frame command pools, for the secondary command buffers
+        ParallelRecorder parallelRecorder_;
+        VkSubpassContents subpassContents_ = VK_SUBPASS_CONTENTS_INLINE;
+
         SynchronisationObjects syncObjs_;
 
-        //Save
-        GraphicsPipeline* savedPipeline_ = nullptr;
+        //Objects retired while frames were still using them (swap chain recreation)
+        DeletionQueue deletionQueue_;
+
+        //Batch the copies to the GPU memory
+        UploadManager uploadManager_;
+
+        //Upload semaphores waited by each frame in flight, given back to the upload manager once the frame is done
+        std::vector<std::vector<GpuTimeline::Wait>> uploadWaits_;
+
+        //Compute queue, its submissions run in parallel of the previous frames
+        AsyncCompute asyncCompute_;
+
+        //Compute submissions waited by the frame being recorded
+        std::vector<GpuTimeline::Wait> computeWaits_;
+
+        //Per draw uniforms, one region per frame in flight
+        UniformRing uniformRing_;
+
+        //Must outlive the shaders
+        DescriptorAllocator descriptorAllocator_;
+
+        //Timestamps and CPU phases of each frame
+        Profiler profiler_;
+        Profiler::TimePoint recordingStart_;
+
+        //Headless readbacks waiting for their frame to be finished, by frame in flight
+        std::vector<ReadbackCallback> readbackCallbacks_;
 };
 
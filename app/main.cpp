@@ -71,7 +71,7 @@ class HelloTriangleApplication {
 public:
 
 	HelloTriangleApplication() : window_("Tesvoxel", WIDTH, HEIGHT), vulkanWrapper_(window_.get(), MAX_FRAMES_IN_FLIGHT, DEPTH_CHECK), vertexData_(vulkanWrapper_.generateVertexData()),
-	testShader_(vulkanWrapper_.generateShader("Shaders/main.vert.spv", "Shaders/main.frag.spv")), testGraphicsPipeline_()
+	testShader_(vulkanWrapper_.generateShader("Shaders/main.vert.spv", "Shaders/main.frag.spv"))
  {}
 
     void run() {
@@ -111,17 +111,32 @@ public:
 			return;
 		}
 
-		std::cout << "delta time: " << deltaTime << std::endl;
+		//Print the last profiled frame about once per second
+		static float timeSinceProfileDump = 0.0f;
+		timeSinceProfileDump += deltaTime;
+		if (timeSinceProfileDump >= 1.0f) {
+			timeSinceProfileDump = 0.0f;
+			vulkanWrapper_.getProfiler().dump(std::cout);
+
+			PipelineStateCache::Statistics pipelineStatistics = vulkanWrapper_.getPipelineStatistics();
+			std::cout << "Pipelines : " << pipelineStatistics.pipelineCount << " (" << pipelineStatistics.hits << " hits, " << pipelineStatistics.misses << " misses)" << std::endl;
+		}
 
 		//Can be here or before "beginRecordingDraw"
 		updateUniformBuffer(currentFrame, timeFromStart);
 		
 		testShader_.recordPushConstant(currentCommandBuffer, &timeFromStart, sizeof(timeFromStart));
 
-		testGraphicsPipeline_.bind(currentCommandBuffer);
-		testShader_.bind(currentCommandBuffer, currentFrame);
+		//Per draw uniform, pushed in the ring of the frame
+		glm::vec3 color(1.0f, 0.0f, 0.0f);
+		uint32_t colorOffset = vulkanWrapper_.getUniformRing().push(&color, sizeof(color));
+
+		vulkanWrapper_.beginProfileScope(currentCommandBuffer, "test draw");
+		testGraphicsPipeline_->bind(currentCommandBuffer);
+		testShader_.bind(currentCommandBuffer, currentFrame, {&colorOffset, 1});
 		vertexData_.bind(currentCommandBuffer);
 		vertexData_.draw(currentCommandBuffer);
+		vulkanWrapper_.endProfileScope(currentCommandBuffer);
 
 		//Bind pipeline
 		//Bind shader
@@ -144,10 +159,7 @@ public:
 
 		// memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
 
-		glm::vec3 color(1.0f, 0.0f, 0.0f);
-
 		testShader_.updateUniform(0, currentFrame, &ubo, sizeof(ubo));
-		testShader_.updateUniform(1, currentFrame, &color, sizeof(color));
 		// testShader_.updateUniform(2, currentFrame, &time, sizeof(time));
 
 	}
@@ -165,8 +177,8 @@ private:
 	// Uniform buffers
 	Shader testShader_;
 
-	//The full graphic pipeline
-	GraphicsPipeline testGraphicsPipeline_;
+	//The full graphic pipeline, owned by the wrapper
+	GraphicsPipeline* testGraphicsPipeline_ = nullptr;
 
 	bool framebufferResized = false;
 
@@ -177,11 +189,14 @@ private:
 		
 		// createUniformBuffers();
 		testShader_.addUniformBufferObjects({
-			{0, sizeof(UniformBufferObject), VK_SHADER_STAGE_VERTEX_BIT},
-			{1, sizeof(glm::vec3), VK_SHADER_STAGE_VERTEX_BIT}
+			{0, sizeof(UniformBufferObject), VK_SHADER_STAGE_VERTEX_BIT}
 			// {2, sizeof(float), VK_SHADER_STAGE_VERTEX_BIT}
 		});
 
+		testShader_.addDynamicUniformBufferObjects(vulkanWrapper_.getUniformRing(), {
+			{1, sizeof(glm::vec3), VK_SHADER_STAGE_VERTEX_BIT}
+		});
+
 
 		testShader_.setPushConstant({sizeof(float), VK_SHADER_STAGE_VERTEX_BIT});
 
@@ -191,8 +206,7 @@ private:
 
 		testShader_.generateBindingsAndSets();
 		
-		testGraphicsPipeline_ = vulkanWrapper_.generateGraphicsPipeline(testShader_, {3, 3, 2});
-		vulkanWrapper_.saveGraphicPipeline(&testGraphicsPipeline_);
+		testGraphicsPipeline_ = &vulkanWrapper_.generateGraphicsPipeline(testShader_, {3, 3, 2});
 
 		createVertexBuffer();
 
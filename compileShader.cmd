@@ -1,2 +1,3 @@
 glslc resources/shaders/main.vert -o resources/shaders/main.vert.spv
 glslc resources/shaders/main.frag -o resources/shaders/main.frag.spv
+glslc resources/shaders/cull.comp -o resources/shaders/cull.comp.spv